@@ -26,6 +26,13 @@ public:
 	virtual bool isDone() const;
 	virtual bool perform(Actor& actor) = 0;
 
+	// NOTE: the actions are allocated from per-thread free lists by size, the memory is reused instead of freed
+	static void* operator new(std::size_t size);
+	static void operator delete(void* pointer, std::size_t size);
+
+	static std::size_t getAllocationCount(); // heap allocations made for the actions
+	static std::size_t getLiveCount();
+
 	static void setWorld(World& world);
 	static void setStateStack(StateStack& stack);
 
@@ -4,6 +4,8 @@
 
 #include "Action.hpp"
 
+#include <memory>
+
 namespace rl
 {
 
@@ -16,8 +18,12 @@ public:
 
 	bool canTakeTurn() const;
 	bool gainEnergy();
+	bool gainEnergy(int ticks);
 	void spendEnergy();
 
+	// 0 if the actor can take a turn
+	int getTicksToTurn() const;
+
 	virtual bool needsInput() const;
 
 	Action* getAction() const;
@@ -28,12 +34,27 @@ public:
 
 	static int ticksPerTurn();
 
+	// NOTE: expires with this object (not shared by its copies), lets the holders of a pointer detect it dangling;
+	//       kept in release builds too, so that the layout does not depend on NDEBUG (the library and the game may differ)
+	std::weak_ptr<const void> getLifetime() const;
+
 	// TODO: save/load
 
+private:
+	struct Lifetime
+	{
+		Lifetime() = default;
+		Lifetime(const Lifetime&) {}
+		Lifetime& operator=(const Lifetime&) { return *this; }
+
+		std::shared_ptr<const void> token = std::make_shared<char>();
+	};
+
 private:
 	int m_speed = 0;
 	int m_energy = 0;
 	Action::Ptr m_action = nullptr;
+	Lifetime m_lifetime;
 };
 
 template <typename T, typename... Args>
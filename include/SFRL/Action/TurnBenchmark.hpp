@@ -0,0 +1,48 @@
+#pragma once
+
+#include "TurnManager.hpp"
+
+#include <SFML/System/Time.hpp>
+
+#include <functional>
+#include <ostream>
+#include <memory>
+#include <vector>
+
+namespace rl
+{
+
+// times the same actors taking their turns with polling and with scheduling (TurnManager::setScheduling)
+// NOTE: create makes a new set of actors with their actions, the same for both runs; the speeds and the number
+//       of actors decide which mode wins, e.g. polling visits every actor each tick, slow actors make it worse
+template <typename Actor>
+class TurnBenchmark
+{
+public:
+	using Actors = std::vector<std::unique_ptr<Actor>>;
+	using Create = std::function<Actors()>;
+
+	struct Run
+	{
+		bool scheduling = false;
+		std::size_t actions = 0;
+		std::size_t turns = 0;
+		sf::Time time;
+	};
+
+public:
+	// polling, then scheduling, actionCount calls of processActions each (fewer if an actor needs input)
+	const std::vector<Run>& run(const Create& create, std::size_t actionCount);
+
+	const std::vector<Run>& getRuns() const;
+	float getSpeedup() const; // polling time / scheduling time
+
+	void print(std::ostream& stream) const;
+
+private:
+	std::vector<Run> m_runs;
+};
+
+}
+
+#include "TurnBenchmark.inl"
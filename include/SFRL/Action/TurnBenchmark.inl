@@ -0,0 +1,67 @@
+#include <SFML/System/Clock.hpp>
+
+namespace rl
+{
+
+template <typename Actor>
+const std::vector<typename TurnBenchmark<Actor>::Run>& TurnBenchmark<Actor>::run(const Create& create, std::size_t actionCount)
+{
+	m_runs.clear();
+
+	for (bool scheduling : { false, true })
+	{
+		Actors actors = create();
+
+		TurnManager<Actor> manager;
+		manager.setScheduling(scheduling);
+
+		for (auto& actor : actors)
+			manager.addActor(*actor);
+
+		Run run;
+		run.scheduling = scheduling;
+
+		sf::Clock clock;
+
+		while (run.actions < actionCount && manager.processActions())
+			++run.actions;
+
+		run.time = clock.getElapsedTime();
+		run.turns = manager.getTurnCount();
+
+		m_runs.push_back(run);
+	}
+
+	return m_runs;
+}
+
+template <typename Actor>
+const std::vector<typename TurnBenchmark<Actor>::Run>& TurnBenchmark<Actor>::getRuns() const
+{
+	return m_runs;
+}
+
+template <typename Actor>
+float TurnBenchmark<Actor>::getSpeedup() const
+{
+	if (m_runs.size() < 2 || m_runs[1].time == sf::Time::Zero)
+		return 0.f;
+
+	return m_runs[0].time.asSeconds() / m_runs[1].time.asSeconds();
+}
+
+template <typename Actor>
+void TurnBenchmark<Actor>::print(std::ostream& stream) const
+{
+	for (const auto& run : m_runs)
+	{
+		stream << (run.scheduling ? "scheduling" : "polling")
+			<< ": actions: " << run.actions
+			<< ", turns: " << run.turns
+			<< ", time: " << run.time.asMicroseconds() / 1000.f << " ms" << '\n';
+	}
+
+	stream << "speedup: " << getSpeedup() << '\n';
+}
+
+}
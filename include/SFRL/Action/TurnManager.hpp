@@ -1,8 +1,15 @@
 #pragma once
 
 #include "Action.hpp"
+#include "../WorkerPool.hpp"
+#include "../Rng.hpp"
 
+#include <functional>
+#include <algorithm>
 #include <vector>
+#include <memory>
+#include <array>
+#include <cstdint>
 
 namespace rl
 {
@@ -10,26 +17,119 @@ namespace rl
 template <typename Actor>
 class TurnManager
 {
+public:
+	// the action of an actor without one (AI), nullptr waits for the input
+	// NOTE: rng is a substream of the seed for the tick and the actor, decide must use it instead of a shared Rng
+	//       so that the decisions are the same with any thread count
+	using Decide = std::function<Action::Ptr(const Actor& actor, Rng& rng)>;
+	// false if a decision made before the other actions of its tick has to be made again
+	using Validate = std::function<bool(const Actor& actor, const Action& action)>;
+
 public:
 	void clear();
 	void addActor(Actor& actor);
 	// void removeActor(Actor& actor);
 	void setActors(std::vector<Actor*>&& actors);
 
+	// jump to the next actor that can take a turn instead of giving energy to all the actors every tick
+	// NOTE: the turns are taken in the same order, but a waiting actor only gains its energy when its turn comes;
+	//       reschedule must be called after changing the speed of an actor, or the new speed applies from its next turn
+	void setScheduling(bool enabled);
+	// gains the energy of the ticks already waited at the old speed and queues the next turn at the new speed
+	void reschedule(Actor& actor);
+
+	// NOTE: with scheduling, validate and more than one thread, the actors of a tick decide concurrently before the first
+	//       action of the tick is performed, decide must only read the world; the actions are still performed in order,
+	//       a decision is validated before use if other actions were performed since, and decided again if rejected
+	//       (validate must reject every decision the serial order could change); without validate, decide is serial
+	void setDecision(Decide decide, Validate validate = {}, unsigned int seed = std::random_device()());
+	unsigned int getThreadCount() const;
+	void setThreadCount(unsigned int count); // 0: all cores
+
+
 	bool processActions();
 	void removeWrecks();
 
+	// performs the turns back to back (e.g. resting) until an actor needs input, interrupt returns true or the limit
+	// NOTE: called from one update, nothing is drawn until it returns; an action spanning frames (perform returns false)
+	//       also stops it, returns the turns passed
+	std::size_t fastForward(std::size_t turns, const std::function<bool()>& interrupt = {});
+
+	std::size_t getTurnCount() const;
+
 	// TODO: save/load
 
 private:
+	struct Turn
+	{
+		std::size_t tick = 0;  // the actor can take its turn
+		std::size_t visit = 0; // first tick of the wait
+		int gains = 0;         // ticks of energy to gain, 0 once gained
+		int speed = 0;         // speed of the wait
+		bool queued = false;
+		Action::Ptr decision = nullptr;
+	};
+
+	// NOTE: asserts on use once the actor is destroyed without being removed (dangling pointer) in debug builds
+	class ActorRef
+	{
+	public:
+		ActorRef(Actor* actor);
+
+		Actor* get() const;
+		Actor* operator->() const;
+		Actor& operator*() const;
+
+	private:
+		Actor* m_actor;
+		std::weak_ptr<const void> m_lifetime; // NOTE: not only in debug builds, the layout must not depend on NDEBUG
+	};
+
+	// NOTE: a wait is at most ceil(ActionCost / slowest gain) = 16 ticks, so the turns are kept in a timing wheel;
+	//       a bucket has one bit per actor, its turns are visited in the actor order without sorting
+	//       (a turn 16 ticks after the current one shares its bucket, it is skipped by its tick)
+	static constexpr std::size_t WheelSize = 16;
+
+	bool processScheduled();
+	bool findTurn(std::size_t& order) const;
+	void scheduleAll();
+	void schedule(std::size_t order, std::size_t visit);
+	void queue(std::size_t order, Turn turn);
+	void unqueue(std::size_t order);
+	void rescheduleCurrent();
+	void resizeSchedule();
+	void clearSchedule();
+	void settle();
+
+	void decideTick(std::size_t tick);
+	void decideAction(Actor& actor, Turn* turn);
+	Rng getDecisionRng(std::size_t tick, std::size_t order) const;
+
+	static std::size_t countTrailingZeros(std::uint64_t word);
+
 	Actor* getCurrentActor() const;
 	void advanceActor();
 
 private:
-	std::vector<Actor*> m_actors;
+	std::vector<ActorRef> m_actors;
 	std::size_t m_current = 0;
 	std::size_t m_ticks = 0;
 	std::size_t m_turns = 0;
+
+	std::vector<Turn> m_schedule;                              // turn of each actor (same index as m_actors)
+	std::array<std::vector<std::uint64_t>, WheelSize> m_wheel; // queued actors by tick % WheelSize, a bit per actor
+	std::size_t m_queued = 0;
+	bool m_scheduling = false;
+
+	Decide m_decide;
+	Validate m_validate;
+	unsigned int m_seed = 0;
+	unsigned int m_threadCount = 1;
+	std::unique_ptr<WorkerPool> m_pool; // created by the first threaded decisions
+	std::size_t m_decidedTick = static_cast<std::size_t>(-1);
+	std::size_t m_performed = 0;     // actions performed
+	std::size_t m_finished = 0;      // turns finished
+	std::size_t m_decidedAfter = 0;  // actions performed before the decisions of m_decidedTick
 };
 
 }
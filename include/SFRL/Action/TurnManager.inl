@@ -1,10 +1,43 @@
+#include <thread>
+#include <atomic>
+#include <cassert>
+
 namespace rl
 {
 
+template <typename Actor>
+TurnManager<Actor>::ActorRef::ActorRef(Actor* actor)
+	: m_actor(actor)
+	, m_lifetime(actor->getLifetime())
+{
+}
+
+template <typename Actor>
+Actor* TurnManager<Actor>::ActorRef::get() const
+{
+	// NOTE: the actor was deleted while still managed (dangling pointer)
+	assert(!m_lifetime.expired());
+
+	return m_actor;
+}
+
+template <typename Actor>
+Actor* TurnManager<Actor>::ActorRef::operator->() const
+{
+	return get();
+}
+
+template <typename Actor>
+Actor& TurnManager<Actor>::ActorRef::operator*() const
+{
+	return *get();
+}
+
 template <typename Actor>
 void TurnManager<Actor>::clear()
 {
 	m_actors.clear();
+	clearSchedule();
 	m_current = 0;
 }
 
@@ -12,6 +45,13 @@ template <typename Actor>
 void TurnManager<Actor>::addActor(Actor& actor)
 {
 	m_actors.emplace_back(&actor);
+
+	// NOTE: the new actor is after the current one, it is visited in the current tick
+	if (m_scheduling)
+	{
+		resizeSchedule();
+		schedule(m_actors.size() - 1, m_ticks);
+	}
 }
 
 /*
@@ -19,7 +59,7 @@ template <typename Actor>
 void TurnManager<Actor>::removeActor(Actor& actor)
 {
 	auto found = std::find_if(m_actors.begin(), m_actors.end(),
-		[&] (const auto& a) { return a == &actor; });
+		[&] (const auto& a) { return a.get() == &actor; });
 	assert(found != m_actors.end());
 
 	m_actors.erase(found);
@@ -29,13 +69,90 @@ void TurnManager<Actor>::removeActor(Actor& actor)
 template <typename Actor>
 void TurnManager<Actor>::setActors(std::vector<Actor*>&& actors)
 {
-	m_actors = std::move(actors);
+	m_actors.assign(actors.begin(), actors.end());
 	m_current = 0;
+
+	if (m_scheduling)
+		scheduleAll();
+}
+
+template <typename Actor>
+void TurnManager<Actor>::setScheduling(bool enabled)
+{
+	if (m_scheduling == enabled)
+		return;
+
+	m_scheduling = enabled;
+
+	if (m_scheduling)
+		scheduleAll();
+	else
+		settle();
+}
+
+template <typename Actor>
+void TurnManager<Actor>::reschedule(Actor& actor)
+{
+	if (!m_scheduling)
+		return;
+
+	const auto found = std::find_if(m_actors.begin(), m_actors.end(), [&](const ActorRef& ref) { return ref.get() == &actor; });
+
+	if (found == m_actors.end())
+		return;
+
+	const std::size_t order = found - m_actors.begin();
+	const Turn& turn = m_schedule[order];
+
+	if (!turn.queued)
+		return;
+
+	// NOTE: like settle, polling visited the actors before m_current in this tick already
+	const std::size_t next = order < m_current ? m_ticks + 1 : m_ticks;
+	const int waited = static_cast<int>(std::min<std::size_t>(next - turn.visit, turn.gains));
+
+	if (waited > 0)
+	{
+		const int speed = actor.getSpeed();
+
+		actor.setSpeed(turn.speed);
+		actor.gainEnergy(waited);
+		actor.setSpeed(speed);
+	}
+
+	unqueue(order);
+	schedule(order, next);
+}
+
+template <typename Actor>
+void TurnManager<Actor>::setDecision(Decide decide, Validate validate, unsigned int seed)
+{
+	m_decide = std::move(decide);
+	m_validate = std::move(validate);
+	m_seed = seed;
+}
+
+template <typename Actor>
+unsigned int TurnManager<Actor>::getThreadCount() const
+{
+	if (m_threadCount > 0)
+		return m_threadCount;
+
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+template <typename Actor>
+void TurnManager<Actor>::setThreadCount(unsigned int count)
+{
+	m_threadCount = count;
 }
 
 template <typename Actor>
 bool TurnManager<Actor>::processActions()
 {
+	if (m_scheduling)
+		return processScheduled();
+
 	if (m_actors.empty())
 		return false;
 
@@ -51,6 +168,9 @@ bool TurnManager<Actor>::processActions()
 
 		if (!actor->isDestroyed() && (actor->canTakeTurn() || actor->gainEnergy()))
 		{
+			if (!actor->getAction())
+				decideAction(*actor, nullptr);
+
 			if (actor->needsInput())
 				return false;
 
@@ -65,10 +185,13 @@ bool TurnManager<Actor>::processActions()
 			advanceActor();
 	}
 
+	++m_performed;
+
 	if (action->perform(*actor))
 	{
 		actor->spendEnergy();
 		actor->finishTurn();
+		++m_finished;
 
 		advanceActor();
 	}
@@ -79,49 +202,286 @@ bool TurnManager<Actor>::processActions()
 	return true;
 }
 
+template <typename Actor>
+std::size_t TurnManager<Actor>::fastForward(std::size_t turns, const std::function<bool()>& interrupt)
+{
+	const std::size_t first = m_turns;
+
+	while (m_turns - first < turns)
+	{
+		const std::size_t finished = m_finished;
+
+		if (!processActions() || m_finished == finished)
+			break;
+
+		if (interrupt && interrupt())
+			break;
+	}
+
+	return m_turns - first;
+}
+
+template <typename Actor>
+std::size_t TurnManager<Actor>::getTurnCount() const
+{
+	return m_turns;
+}
+
 template <typename Actor>
 void TurnManager<Actor>::removeWrecks()
 {
-	Actor* actor = getCurrentActor();
+	// NOTE: one pass keeps the turn order, the next actor takes the place of a removed current actor
+	std::vector<Turn> turns;
+	std::size_t current = 0;
+	std::size_t count = 0;
+
+	if (m_scheduling)
+	{
+		turns = std::move(m_schedule);
+		clearSchedule();
+		m_schedule.resize(m_actors.size());
+	}
 
-	for (auto it = m_actors.begin(); it != m_actors.end(); )
+	for (std::size_t i = 0; i < m_actors.size(); ++i)
 	{
-		if ((*it)->isDestroyed())
+		if (i == m_current)
+			current = count;
+
+		if (m_actors[i]->isDestroyed())
+			continue;
+
+		// NOTE: the destroyed actors still queued are the ones not reached yet
+		if (m_scheduling && turns[i].queued)
 		{
-			if (*it == actor)
-			{
-				it = m_actors.erase(it);
+			// the rng of a decision depends on the order
+			if (count != i)
+				turns[i].decision = nullptr;
 
-				if (it == m_actors.end())
-					actor = nullptr;
-				else
-					actor = *it;
-			}
+			queue(count, std::move(turns[i]));
+		}
+
+		m_actors[count++] = m_actors[i];
+	}
+
+	m_actors.erase(m_actors.begin() + count, m_actors.end());
+	m_current = current < count ? current : 0;
+
+	if (m_scheduling)
+		resizeSchedule();
+}
+
+template <typename Actor>
+bool TurnManager<Actor>::processScheduled()
+{
+	static const std::size_t ticksPerTurn = Energy::ticksPerTurn();
 
-			else
-				it = m_actors.erase(it);
+	Actor* actor = nullptr;
+	Action* action = nullptr;
+
+	while (!action)
+	{
+		std::size_t order = 0;
+
+		if (!findTurn(order))
+			return false;
+
+		Turn& turn = m_schedule[order];
+		actor = m_actors[order].get();
+
+		if (actor->isWalking())
+			return false;
+
+		// jump to the turn
+		m_current = order;
+		m_ticks = turn.tick;
+		m_turns = m_ticks / ticksPerTurn;
+
+		if (actor->isDestroyed())
+		{
+			unqueue(order);
+
+			advanceActor();
+			continue;
 		}
 
-		else
-			++it;
+		// NOTE: without validate, every decision but the first of the tick would be made again
+		if (m_decide && m_validate && m_decidedTick != m_ticks && getThreadCount() > 1)
+			decideTick(m_ticks);
+
+		if (turn.gains > 0)
+		{
+			actor->gainEnergy(turn.gains);
+			turn.gains = 0;
+		}
+
+		// NOTE: the actor may have slowed down while waiting
+		if (!actor->canTakeTurn())
+		{
+			rescheduleCurrent();
+			continue;
+		}
+
+		if (!actor->getAction())
+			decideAction(*actor, &turn);
+
+		if (actor->needsInput())
+			return false;
+
+		action = actor->getAction();
+
+		// HACK: vehicle
+		if (!action)
+			rescheduleCurrent();
 	}
 
-	m_current = 0;
+	++m_performed;
 
-	for (std::size_t i = 0; i < m_actors.size(); ++i)
+	if (action->perform(*actor))
 	{
-		if (m_actors[i] == actor)
+		actor->spendEnergy();
+		actor->finishTurn();
+		++m_finished;
+
+		rescheduleCurrent();
+	}
+
+	if (action->isDone())
+		actor->setAction(nullptr);
+
+	return true;
+}
+
+template <typename Actor>
+bool TurnManager<Actor>::findTurn(std::size_t& order) const
+{
+	if (m_queued == 0)
+		return false;
+
+	// NOTE: the turns before (m_ticks, m_current) were all taken
+	for (std::size_t tick = m_ticks, first = m_current; ; ++tick, first = 0)
+	{
+		const auto& bucket = m_wheel[tick % WheelSize];
+
+		for (std::size_t i = first / 64; i < bucket.size(); ++i)
 		{
-			m_current = i;
-			break;
+			std::uint64_t word = bucket[i];
+
+			if (i == first / 64)
+				word &= ~std::uint64_t(0) << (first % 64);
+
+			for (; word != 0; word &= word - 1)
+			{
+				const std::size_t found = i * 64 + countTrailingZeros(word);
+
+				if (m_schedule[found].tick == tick)
+				{
+					order = found;
+					return true;
+				}
+			}
 		}
 	}
 }
 
+template <typename Actor>
+void TurnManager<Actor>::scheduleAll()
+{
+	clearSchedule();
+	resizeSchedule();
+
+	for (std::size_t i = 0; i < m_actors.size(); ++i)
+	{
+		if (!m_actors[i]->isDestroyed())
+			schedule(i, i < m_current ? m_ticks + 1 : m_ticks);
+	}
+}
+
+template <typename Actor>
+void TurnManager<Actor>::schedule(std::size_t order, std::size_t visit)
+{
+	const int gains = m_actors[order]->getTicksToTurn();
+
+	// the actor gains energy once per tick until it can take its turn
+	const std::size_t tick = gains > 0 ? visit + gains - 1 : visit;
+
+	queue(order, { tick, visit, gains, m_actors[order]->getSpeed(), true, nullptr });
+}
+
+template <typename Actor>
+void TurnManager<Actor>::queue(std::size_t order, Turn turn)
+{
+	assert(order < m_schedule.size() && !m_schedule[order].queued);
+
+	m_wheel[turn.tick % WheelSize][order / 64] |= std::uint64_t(1) << (order % 64);
+	m_schedule[order] = std::move(turn);
+	++m_queued;
+}
+
+template <typename Actor>
+void TurnManager<Actor>::unqueue(std::size_t order)
+{
+	Turn& turn = m_schedule[order];
+
+	m_wheel[turn.tick % WheelSize][order / 64] &= ~(std::uint64_t(1) << (order % 64));
+	turn.queued = false;
+	turn.decision = nullptr;
+	--m_queued;
+}
+
+template <typename Actor>
+void TurnManager<Actor>::rescheduleCurrent()
+{
+	const std::size_t order = m_current;
+	unqueue(order);
+
+	advanceActor();
+
+	schedule(order, order < m_current ? m_ticks + 1 : m_ticks);
+}
+
+template <typename Actor>
+void TurnManager<Actor>::resizeSchedule()
+{
+	m_schedule.resize(m_actors.size());
+
+	for (auto& bucket : m_wheel)
+		bucket.resize((m_actors.size() + 63) / 64, 0);
+}
+
+template <typename Actor>
+void TurnManager<Actor>::clearSchedule()
+{
+	m_schedule.clear();
+
+	for (auto& bucket : m_wheel)
+		std::fill(bucket.begin(), bucket.end(), 0);
+
+	m_queued = 0;
+}
+
+template <typename Actor>
+void TurnManager<Actor>::settle()
+{
+	// gain the energy of the ticks already passed, then polling takes over from m_current
+	for (std::size_t i = 0; i < m_schedule.size(); ++i)
+	{
+		const Turn& turn = m_schedule[i];
+
+		if (!turn.queued)
+			continue;
+
+		const std::size_t next = i < m_current ? m_ticks + 1 : m_ticks;
+
+		m_actors[i]->gainEnergy(static_cast<int>(std::min<std::size_t>(next - turn.visit, turn.gains)));
+	}
+
+	clearSchedule();
+}
+
 template <typename Actor>
 Actor* TurnManager<Actor>::getCurrentActor() const
 {
-	return m_actors[m_current];
+	return m_actors[m_current].get();
 }
 
 template <typename Actor>
@@ -138,4 +498,106 @@ void TurnManager<Actor>::advanceActor()
 	}
 }
 
+template <typename Actor>
+void TurnManager<Actor>::decideTick(std::size_t tick)
+{
+	m_decidedTick = tick;
+	m_decidedAfter = m_performed;
+
+	// the turns of the tick, from the current one
+	std::vector<std::size_t> orders;
+	const auto& bucket = m_wheel[tick % WheelSize];
+
+	for (std::size_t i = m_current / 64; i < bucket.size(); ++i)
+	{
+		std::uint64_t word = bucket[i];
+
+		if (i == m_current / 64)
+			word &= ~std::uint64_t(0) << (m_current % 64);
+
+		for (; word != 0; word &= word - 1)
+		{
+			const std::size_t order = i * 64 + countTrailingZeros(word);
+			const Turn& turn = m_schedule[order];
+			const Actor* actor = m_actors[order].get();
+
+			if (turn.tick == tick && !turn.decision && !actor->isDestroyed() && !actor->getAction())
+				orders.emplace_back(order);
+		}
+	}
+
+	std::atomic<std::size_t> next = 0;
+
+	// each decision is written to its own turn
+	const auto work = [&] ()
+	{
+		for (std::size_t i = next++; i < orders.size(); i = next++)
+		{
+			Rng rng = getDecisionRng(tick, orders[i]);
+			m_schedule[orders[i]].decision = m_decide(*m_actors[orders[i]], rng);
+		}
+	};
+
+	if (orders.size() < 2)
+	{
+		work();
+		return;
+	}
+
+	// NOTE: the threads are kept between the ticks, only recreated when the count changes
+	if (!m_pool || m_pool->getThreadCount() != getThreadCount())
+		m_pool = std::make_unique<WorkerPool>(getThreadCount());
+
+	m_pool->run(work);
+}
+
+template <typename Actor>
+void TurnManager<Actor>::decideAction(Actor& actor, Turn* turn)
+{
+	if (!m_decide)
+		return;
+
+	Action::Ptr action = nullptr;
+
+	if (turn && turn->decision)
+	{
+		action = std::move(turn->decision);
+
+		// NOTE: the world may have changed since the decision
+		if (m_performed != m_decidedAfter && !m_validate(actor, *action))
+			action = nullptr;
+	}
+
+	if (!action)
+	{
+		// NOTE: the same stream as the concurrent decision, a rejected decision is made again with the same rolls
+		Rng rng = getDecisionRng(m_ticks, m_current);
+		action = m_decide(actor, rng);
+	}
+
+	if (action)
+		actor.setAction(std::move(action));
+}
+
+template <typename Actor>
+Rng TurnManager<Actor>::getDecisionRng(std::size_t tick, std::size_t order) const
+{
+	return Rng(m_seed ^ static_cast<unsigned int>(tick), static_cast<unsigned int>(order));
+}
+
+template <typename Actor>
+std::size_t TurnManager<Actor>::countTrailingZeros(std::uint64_t word)
+{
+	// NOTE: de Bruijn multiplication, the lowest set bit selects the entry
+	static constexpr std::size_t Table[64] =
+	{
+		 0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+		62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+		63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+		46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6,
+	};
+
+	return Table[((word & (~word + 1)) * 0x03F79D71B4CB0A89) >> 58];
+}
+
 }
@@ -6,18 +6,64 @@
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include <functional>
+#include <ostream>
+#include <memory>
+#include <vector>
 
 namespace rl
 {
 
 class Application
 {
+public:
+	struct InputEvent
+	{
+		std::size_t frame;
+		sf::Event event;
+	};
+
+	// events of a frame, scripted or replayed
+	using Input = std::function<void(std::size_t frame, std::vector<sf::Event>& events)>;
+
+	struct HeadlessReport
+	{
+		std::size_t frames = 0;
+		std::size_t turns = 0;
+		sf::Time input;  // scripted events handled by the states
+		sf::Time update;
+		sf::Time total;
+
+		float getTurnsPerSecond() const;
+		void print(std::ostream& stream) const;
+	};
+
 public:
 	void run();
 
+	// runs the states without a window (no rendering) until the stack is empty or frameCount frames
+	// NOTE: the states get timePerFrame as dt; with fixedRate the frames take timePerFrame of real time,
+	//       otherwise they run at CPU speed; turnCount reads the turns for the report (e.g. TurnManager::getTurnCount)
+	HeadlessReport runHeadless(std::size_t frameCount, const Input& input, sf::Time timePerFrame = sf::seconds(1.f / 60.f),
+		bool fixedRate = false, const std::function<std::size_t()>& turnCount = {});
+
+	// records the events given to the states by run(), to replay them headless
+	void setRecording(bool enabled);
+	const std::vector<InputEvent>& getRecording() const;
+	static Input replay(std::vector<InputEvent> events);
+
 protected:
 	Application();
 
+	// NOTE: the window (and its OpenGL context) only exists after create, runHeadless does not need it
+	void create(sf::VideoMode mode, const sf::String& title, sf::Uint32 style = sf::Style::Default,
+		const sf::ContextSettings& settings = sf::ContextSettings());
+
+	// NOTE: creates a closed window the first time (it opens the display), m_window may be null before
+	sf::RenderWindow& getWindow();
+
 	void initializeFpsText(const sf::Font& font, int fontSize);
 	void initializeDebugGrid(const sf::Vector2i& gridSize);
 	void initializeFilter(/* FilterType filter */);
@@ -34,7 +80,7 @@ protected:
 protected:
 	ResourceManager m_resources;
 	StateStack m_stateStack;
-	sf::RenderWindow m_window;
+	std::unique_ptr<sf::RenderWindow> m_window;
 	sf::Color m_clearColor = sf::Color::Black;
 
 	sf::Text m_fpsText;
@@ -45,6 +91,10 @@ protected:
 	bool m_displayFps = false;
 	bool m_displayGrid = false;
 	bool m_displayFilter = false;
+
+	std::size_t m_frame = 0; // since setRecording(true)
+	bool m_recording = false;
+	std::vector<InputEvent> m_recordedEvents;
 };
 
 }
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/Graphics/Vertex.hpp>
 
 #include <array>
 #include <vector>
+#include <unordered_map>
 
 namespace sf
 {
@@ -16,6 +18,8 @@ namespace sf
 namespace rl
 {
 
+class SoftwareTarget;
+
 class Console : public sf::Drawable, public sf::Transformable
 {
 public:
@@ -32,6 +36,11 @@ public:
 	Console(const sf::Vector2i& size, const sf::Font& font, int fontSize);
 
 	void create(const sf::Vector2i& size, const sf::Font& font, int fontSize);
+	void create(const sf::Vector2i& size); // headless (Terminal), not drawable
+
+	// glyphs of the range are cached in a table (ascii by default), other glyphs are cached on first use
+	// NOTE: box-drawing characters and block elements (U+2500 to U+259F) are drawn by the console
+	void preloadGlyphs(wchar_t first, wchar_t last);
 
 	void clear();
 	void clear(Layer layer);
@@ -50,8 +59,55 @@ public:
 	const sf::Vector2i& getSize() const;
 	const sf::Vector2f& getTileSize() const;
 
+	wchar_t getChar(int x, int y) const;
+	const sf::Color& getColor(int x, int y, Layer layer = Background) const;
+
+	// CPU rendering for benchmarks and regression tests
+	// NOTE: glyphs and box characters are solid quads unless the target has images of their textures
+	void draw(SoftwareTarget& target, sf::RenderStates states = sf::RenderStates::Default) const;
+
 private:
+	// NOTE: setters only write the cells, the vertices of the changed cells are updated when drawn
+	struct Cell
+	{
+		bool operator==(const Cell& cell) const;
+		bool operator!=(const Cell& cell) const;
+
+		wchar_t ch = 0;
+		std::array<sf::Color, LayerCount> colors = { sf::Color::Transparent, sf::Color::Transparent, sf::Color::Transparent };
+	};
+
+	struct GlyphRange
+	{
+		wchar_t first;
+		wchar_t last;
+		std::vector<const sf::Glyph*> glyphs;
+	};
+
+	// non-transparent quads drawn together
+	struct Run
+	{
+		int first;
+		int count;
+	};
+
+	// box-drawing characters between the text and the foreground
+	static constexpr int BoxLayer = LayerCount;
+	static constexpr int VertexLayerCount = LayerCount + 1;
+
 	constexpr bool isInBounds(int x, int y) const;
+	bool isEmpty(const Cell& cell, int layer) const;
+
+	void loadGlyphs(GlyphRange& range);
+	const sf::Glyph& getGlyph(wchar_t ch) const;
+	void createBoxTexture();
+
+	void updateCell(int index) const;
+	void updateVertices() const;
+	void updateRuns() const;
+
+	template <typename Target>
+	void render(Target& target, sf::RenderStates states) const;
 
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
@@ -62,8 +118,14 @@ private:
 	sf::Vector2i m_size;
 	sf::Vector2f m_tileSize;
 	sf::Vector2f m_offset;
-	std::array<const sf::Glyph*, 95> m_ascii;
-	std::array<std::vector<sf::Vertex>, LayerCount> m_layers;
+	std::vector<GlyphRange> m_glyphRanges = { { L' ', L'~', {} } }; // ascii
+	mutable std::unordered_map<wchar_t, const sf::Glyph*> m_glyphs;
+	sf::Texture m_boxTexture;
+	std::vector<Cell> m_cells;
+	mutable std::vector<Cell> m_drawnCells;
+	mutable std::array<std::vector<sf::Vertex>, VertexLayerCount> m_layers;
+	mutable std::array<std::vector<Run>, VertexLayerCount> m_runs;
+	mutable bool m_verticesNeedUpdate = false;
 };
 
 constexpr bool Console::isInBounds(int x, int y) const
@@ -46,6 +46,7 @@ public:
 	bool contains(const sf::Vector2f& point) const override;
 	void handleEvent(const sf::Event& event) override;
 	void update(sf::Time dt) override;
+	void appendQuads(QuadBatch& batch, const sf::Transform& transform) const override;
 
 	static void setButtonColors(const sf::Color& selectedColor, const sf::Color& pressedColor);
 
@@ -15,6 +15,8 @@ namespace sf
 namespace rl // rl::gui
 {
 
+class QuadBatch;
+
 enum class Alignment
 {
 	Centered,
@@ -55,6 +57,12 @@ public:
 	virtual void handleEvent(const sf::Event& event);
 	virtual void update(sf::Time dt);
 
+	// batched drawing, see Container (by default the component is drawn on its own)
+	// NOTE: setters mark the component and its parents dirty, the container batch is rebuilt when drawn
+	virtual void appendQuads(QuadBatch& batch, const sf::Transform& transform) const;
+	bool isDirty() const;
+	void markDirty();
+
 	static void setTileSize(const sf::Vector2i& tileSize);
 	static void setFont(const sf::Font& font);
 	static void setFontSize(unsigned int fontSize);
@@ -71,6 +79,8 @@ private:
 	virtual void onDeactivate();
 
 private:
+	friend class Container;
+
 	static sf::Vector2i s_tileSize;
 	static const sf::Font* s_font;
 	static unsigned int s_fontSize;
@@ -78,6 +88,8 @@ private:
 	sf::Vector2i m_position;
 	bool m_selected = false;
 	bool m_active = false;
+	Component* m_parent = nullptr; // Container
+	mutable bool m_dirty = true;
 
 protected:
 	static const sf::Vector2i& TileSize;
@@ -3,6 +3,7 @@
 // TODO: custom iterator
 
 #include "Component.hpp"
+#include "QuadBatch.hpp"
 
 #include <SFML/Window/Keyboard.hpp>
 
@@ -38,6 +39,9 @@ public:
 	void handleEvent(const sf::Event& event) override;
 	void update(sf::Time dt) override;
 
+	// NOTE: the quads of all the children (and their children) are batched, one call per run of the same texture
+	void appendQuads(QuadBatch& batch, const sf::Transform& transform) const override;
+
 	int getSelectedChild() const;
 
 	void select(std::size_t index);
@@ -51,6 +55,8 @@ private:
 	void selectPrevious();
 	void selectNext();
 
+	void appendChildren(QuadBatch& batch, const sf::Transform& transform) const;
+
 	void onActivate() override;
 	void onDeactivate() override;
 
@@ -60,6 +66,7 @@ private:
 	int m_selectedChild = -1;
 	std::vector<Component::Ptr> m_children;
 	std::unordered_map<sf::Keyboard::Key, Action> m_keyBindings;
+	mutable QuadBatch m_batch; // rebuilt when a child is dirty
 };
 
 template <typename T, typename... Args>
@@ -2,7 +2,16 @@
 
 #include "Component.hpp"
 
-#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/String.hpp>
+
+#include <vector>
+
+namespace sf
+{
+	class Glyph;
+}
 
 namespace rl
 {
@@ -29,8 +38,24 @@ public:
 	void setTextWrap(bool flag);
 	void setTextAlignment(Alignment align);
 
+	void appendQuads(QuadBatch& batch, const sf::Transform& transform) const override;
+
 private:
-	void updateTexts() const;
+	// NOTE: lines are spans of m_string, without the whitespace they were broken at
+	struct Line
+	{
+		std::size_t first;
+		std::size_t last;
+	};
+
+	struct Character
+	{
+		const sf::Glyph* glyph; // nullptr for whitespace
+		float kerning;          // with the previous character
+	};
+
+	void updateLines() const;
+	void updateVertices() const;
 
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 	// void draw(Console& console);
@@ -42,9 +67,12 @@ private:
 	sf::String m_string;
 	sf::Color m_color = sf::Color::White;
 	bool m_wrap = false;
-	mutable std::vector<sf::Text> m_texts;
-	mutable bool m_textsNeedUpdate = false;
 	Alignment m_alignment = Alignment::Centered;
+	mutable std::vector<Character> m_characters; // glyphs of m_string
+	mutable std::vector<Line> m_lines;
+	mutable std::vector<sf::Vertex> m_vertices;
+	mutable bool m_linesNeedUpdate = false;    // text, size or wrap changed
+	mutable bool m_verticesNeedUpdate = false; // color or alignment changed
 };
 
 }
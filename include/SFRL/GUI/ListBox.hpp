@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Component.hpp"
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/String.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rl
+{
+
+class Console;
+
+// scrolling list of single-line entries, e.g. a message log or an inventory
+// NOTE: entries are kept in a ring buffer (the oldest entry is dropped when full),
+//       only the visible rows are laid out and each row keeps its layout while it stays in view
+class ListBox : public Component
+{
+public:
+	using Ptr = std::unique_ptr<ListBox>;
+	using Callback = std::function<void(std::size_t index)>;
+
+public:
+	ListBox(const sf::Font& font, int fontSize, const sf::Vector2i& size, std::size_t capacity = 1000);
+	explicit ListBox(const sf::Vector2i& size, std::size_t capacity = 1000);
+
+	const sf::Vector2i& getSize() const;
+	void setSize(const sf::Vector2i& size); // one row per tile
+
+	std::size_t getCapacity() const;
+	void setCapacity(std::size_t capacity); // keeps the newest entries
+
+	// NOTE: index 0 is the oldest entry
+	std::size_t getEntryCount() const;
+	const std::wstring& getEntry(std::size_t index) const;
+
+	void addEntry(const sf::String& string, const sf::Color& color = sf::Color::White);
+	void setEntry(std::size_t index, const sf::String& string, const sf::Color& color = sf::Color::White);
+	void clear();
+
+	// NOTE: a log scrolled to the end follows the new entries
+	std::size_t getScroll() const; // first visible entry
+	void setScroll(std::size_t index);
+	void scroll(int rows);
+	void scrollToEnd();
+
+	int getSelectedEntry() const; // -1 if none
+	void selectEntry(std::size_t index);
+
+	void setCallback(Callback callback); // selected entry activated
+
+	bool isSelectable() const override;
+	void setSelectable(bool flag);
+
+	bool contains(const sf::Vector2f& point) const override;
+	void handleEvent(const sf::Event& event) override;
+	void appendQuads(QuadBatch& batch, const sf::Transform& transform) const override;
+
+	// writes the visible rows into the console cells (the position is in cells)
+	void draw(Console& console) const;
+
+	static void setSelectionColor(const sf::Color& color);
+
+private:
+	static constexpr std::size_t None = static_cast<std::size_t>(-1);
+
+	struct Entry
+	{
+		std::wstring string;
+		sf::Color color;
+	};
+
+	// layout cache of a visible row, the slot of an entry is its sequence number modulo the row count
+	struct Row
+	{
+		std::size_t entry = None; // sequence number
+		std::vector<sf::Vertex> vertices; // at row 0
+	};
+
+	const Entry& getEntryAt(std::size_t sequence) const;
+	Entry& getEntryAt(std::size_t sequence);
+	bool isScrolledToEnd() const;
+	void clampScroll();
+	void invalidateRow(std::size_t sequence);
+
+	void layoutRow(Row& row) const;
+	void updateVertices() const;
+
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+private:
+	static sf::Color s_selectionColor;
+
+	const sf::Font* m_font = nullptr;
+	const int m_fontSize = 0;
+	sf::Vector2i m_size;
+	std::vector<Entry> m_entries; // ring buffer
+	std::size_t m_first = 0;      // sequence number of the oldest entry
+	std::size_t m_count = 0;
+	std::size_t m_scroll = 0;     // sequence number of the first visible entry
+	std::size_t m_selected = None;
+	bool m_selectable = false;
+	Callback m_callback;
+	mutable std::vector<Row> m_rows;
+	mutable std::vector<sf::Vertex> m_vertices; // text of the visible rows
+	mutable std::vector<sf::Vertex> m_selection;
+	mutable bool m_verticesNeedUpdate = true;
+};
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <vector>
+
+namespace sf
+{
+	class Text;
+	class Texture;
+}
+
+namespace rl
+{
+
+// quads of a component tree, consecutive quads of a texture share one vertex array, see Container
+// NOTE: the quads are drawn in the order they are appended, a texture change or another drawable starts a new draw call
+class QuadBatch : public sf::Drawable
+{
+public:
+	void clear();
+
+	void append(const sf::Texture* texture, const sf::Vertex* vertices, std::size_t vertexCount, const sf::Transform& transform);
+	void append(const sf::Text& text, const sf::Transform& transform);
+	void append(const sf::Drawable& drawable, const sf::Transform& transform);
+
+	std::size_t getDrawCallCount() const;
+
+private:
+	struct Layer
+	{
+		const sf::Texture* texture;
+		std::vector<sf::Vertex> vertices;
+	};
+
+	struct Segment
+	{
+		std::vector<Layer> layers;
+		const sf::Drawable* drawable = nullptr;
+		sf::Transform transform;
+	};
+
+	std::vector<sf::Vertex>& getVertices(const sf::Texture* texture);
+
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+private:
+	std::vector<Segment> m_segments;
+};
+
+}
@@ -21,11 +21,14 @@ public:
 
 	void setFrameColor(const sf::Color& color);
 	void setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize, int tileBegin = 0);
+	// NOTE: call markDirty after changing the returned text
 	sf::Text& setTitle(const sf::String& string, const sf::Font& font, int fontSize);
 	sf::Text& setTitle(const sf::String& string);
 
 	int getTitleLength() const;
 
+	void appendQuads(QuadBatch& batch, const sf::Transform& transform) const override;
+
 private:
 	void updateVertices() const;
 
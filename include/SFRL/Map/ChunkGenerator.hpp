@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MapGenerator.hpp"
+#include "../Direction.hpp"
+
+namespace rl
+{
+
+// generates fixed-size chunks of an infinite world in any order
+// each chunk is generated with a halo around it, so local steps (fillNoise, generation)
+// give the same tiles as the neighbor chunks, and roads cross the chunk edges at shared points
+class ChunkGenerator : public MapGenerator
+{
+public:
+	// the generation() steps of onGenerate() widen the unmatched border by 2 + 2 + 1 + 1 tiles
+	static constexpr int MinHalo = 6;
+
+public:
+	ChunkGenerator(unsigned int worldSeed, int chunkSize, int halo = 8); // halo >= MinHalo
+
+	unsigned int getWorldSeed() const;
+	int getChunkSize() const;
+
+	void generateChunk(Map& chunk, const sf::Vector2i& coords);
+
+protected:
+	const sf::Vector2i& getCoords() const; // chunk coordinates
+	const Point& getOrigin() const;        // world position of the top-left tile, including the halo
+
+	// the same noise for the same world position
+	void fillNoise(int wallProb);
+
+	// road crossing the edge of the chunk in the cardinal direction, in local positions
+	// NOTE: both chunks carve the same straight crossing, the road should continue from the inner end
+	bool getRoadCrossing(const Direction& dir, Point& inner, Point& outer) const;
+	void carveRoads(int perturbation = 10);
+
+	// constructBridges() without the bridges crossing the chunk edges (the next chunk would not build them)
+	// NOTE: the regions left unconnected are kept, they may continue in the next chunk
+	void constructInnerBridges();
+
+	unsigned int hash(int x, int y, unsigned int salt = 0) const;
+
+private:
+	void onGenerate() override;
+	void onDecorate() override;
+
+private:
+	unsigned int m_worldSeed;
+	int m_chunkSize;
+	int m_halo;
+	sf::Vector2i m_coords;
+	Point m_origin;
+};
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ChunkGenerator.hpp"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+namespace rl
+{
+
+// infinite world made of chunks generated on background threads around a position
+class ChunkMap
+{
+public:
+	// NOTE: the factory is called from worker threads
+	using Factory = std::function<std::unique_ptr<ChunkGenerator>()>;
+
+public:
+	ChunkMap(Factory factory, int chunkSize, int radius = 1);
+	~ChunkMap();
+
+	ChunkMap(const ChunkMap&) = delete;
+	ChunkMap& operator=(const ChunkMap&) = delete;
+
+	int getChunkSize() const;
+	sf::Vector2i toChunkCoords(const sf::Vector2i& position) const;
+
+	// requests the chunks within the radius and releases the distant chunks
+	void update(const sf::Vector2i& position);
+	void wait();
+
+	std::size_t getChunkCount() const;
+	bool isLoaded(const sf::Vector2i& position) const;
+
+	// nullptr or Tile::Unused if the chunk is not generated yet
+	const Map* getChunk(const sf::Vector2i& coords) const;
+	Tile getTile(const sf::Vector2i& position) const;
+	const Map::Flags* at(const sf::Vector2i& position) const;
+
+private:
+	struct Chunk
+	{
+		std::unique_ptr<Map> map;
+		std::future<std::unique_ptr<Map>> future;
+	};
+
+	static std::uint64_t toKey(const sf::Vector2i& coords);
+
+	void collect();
+
+private:
+	Factory m_factory;
+	int m_chunkSize;
+	int m_radius;
+	std::unordered_map<std::uint64_t, Chunk> m_chunks;
+};
+
+}
@@ -2,16 +2,20 @@
 
 // credit: http://journal.stuffwithstuff.com/2015/09/07/what-the-hero-sees/
 
+#include "Tileset.hpp"
+
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/Graphics/Vertex.hpp>
 
 #include <vector>
+#include <cstdint>
 
 namespace rl
 {
 
 class Map;
+class SoftwareTarget;
 
 // field of view
 class Fov : public sf::Drawable, public sf::Transformable
@@ -32,12 +36,21 @@ public:
 	Fov& operator=(const Fov&) = delete;
 
 	void setTexture(const sf::Vector2i& tileSize, const sf::Texture* texture = nullptr, int tileBegin = 0);
+	void setTileset(const Tileset& tileset, int tileBegin = 0); // NOTE: not copied
 	void setMap(Map& map);
 	void setViewRect(const sf::IntRect& rect);
 
+	// NOTE: the next draw only rebuilds the tiles whose flags (or their neighbors' flags) changed,
+	//       including the changes made outside compute and clear (e.g. magic mapping, loading)
 	void clear();
 	void compute(const sf::Vector2i& position, int range);
 
+	// redraws the tiles whose flags were changed outside compute and clear without computing the fov again
+	void invalidate();
+
+	// CPU rendering for benchmarks and regression tests
+	void draw(SoftwareTarget& target, sf::RenderStates states = sf::RenderStates::Default) const;
+
 private:
 	void refreshOctant(int octant, const sf::Vector2i& start, int range);
 
@@ -48,19 +61,42 @@ private:
 	bool isVisible(int x, int y) const;
 	bool isExplored(int x, int y) const;
 
-	void appendQuad(int x, int y, int tileOffset, const sf::Color& color = sf::Color::White) const;
+	std::uint32_t getSignature(int x, int y) const; // flags of the tile and its neighbors
+	int getSlot(int x, int y) const;
+
+	void setQuad(sf::Vertex* quad, int x, int y, int tileOffset, const sf::Color& color = sf::Color::White) const;
+	sf::Vertex* appendEdges(sf::Vertex* quad, int x, int y, bool visible, const sf::Color& color = sf::Color::White) const;
+	void updateCell(int x, int y) const;
+	void updateCells(int y, int left, int right) const;
+	void updateChangedCells(const sf::IntRect& rect) const;
 	void updateVertices() const;
 
+	template <typename Target>
+	void render(Target& target, sf::RenderStates states) const;
+
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
 private:
-	const sf::Texture* m_texture = nullptr;
+	Tileset m_defaultTileset; // setTexture
+	const Tileset* m_tileset = nullptr; // nullptr: black quads
 	sf::Vector2i m_tileSize;
 	int m_tileBegin = 0;
 	Map* m_map = nullptr;
 	sf::IntRect m_viewRect;
 	std::vector<Shadow> m_shadows;
-	mutable std::vector<sf::Vertex> m_vertices;
+
+	// NOTE: the view is a ring buffer (a tile keeps its slot while it stays in view),
+	//       quads have map positions, so scrolling only builds the newly exposed tiles
+	static constexpr int MaxEdges = 8; // edge quads of a visible tile: visible and explored edges, 4 each at most
+
+	mutable std::vector<sf::Vertex> m_quads;              // one quad per slot
+	mutable std::vector<sf::Vertex> m_edges;              // MaxEdges quads per slot
+	mutable std::vector<int> m_edgeCounts;                // used edge quads per slot
+	mutable std::vector<sf::Vertex> m_vertices;           // used edge quads of the view (drawn)
+	mutable std::vector<std::uint32_t> m_signatures;      // flags each slot was built with
+	mutable std::vector<std::uint8_t> m_flagRows;         // flags read by updateChangedCells
+	mutable sf::IntRect m_builtRect;                      // view rect of the last update
+	mutable bool m_flagsChanged = false;                  // since the last update
 	mutable bool m_verticesNeedUpdate = false;
 };
 
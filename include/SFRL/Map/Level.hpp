@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Map.hpp"
+#include "../SlotMap.hpp"
 #include "../Utility.hpp"
 
+#include <unordered_map>
 #include <memory>
 #include <functional>
 #include <cassert>
@@ -15,7 +17,16 @@ class Level : public Map
 {
 public:
 	using Ptr = std::unique_ptr<Level>;
-	using EntityLayer = std::vector<std::unique_ptr<Entity>>;
+	using EntityLayer = SlotMap<std::unique_ptr<Entity>>;
+
+	struct Handle
+	{
+		typename EntityLayer::Handle slot;
+		std::size_t layer = static_cast<std::size_t>(-1); // id of the entity type
+
+		bool operator==(const Handle& other) const;
+		bool operator!=(const Handle& other) const;
+	};
 
 public:
 	explicit Level(const sf::Vector2i& size = { 0, 0 });
@@ -35,6 +46,12 @@ public:
 	template <typename T>
 	std::unique_ptr<T> detach(Entity& entity);
 
+	// NOTE: a handle outlives its entity, resolve returns nullptr once the entity is detached or removed;
+	//       T must be the type the entity was attached with
+	Handle getHandle(const Entity& entity) const;
+	template <typename T>
+	T* resolve(const Handle& handle) const;
+
 	template <typename T>
 	bool isEmpty() const;
 	template <typename T>
@@ -56,6 +73,7 @@ private:
 
 protected:
 	std::vector<EntityLayer> m_layers;
+	std::unordered_map<const Entity*, Handle> m_handles;
 };
 
 }
@@ -4,6 +4,18 @@ namespace rl
 template <typename Entity>
 std::size_t Level<Entity>::s_idCounter = 0;
 
+template <typename Entity>
+bool Level<Entity>::Handle::operator==(const Handle& other) const
+{
+	return slot == other.slot && layer == other.layer;
+}
+
+template <typename Entity>
+bool Level<Entity>::Handle::operator!=(const Handle& other) const
+{
+	return !(*this == other);
+}
+
 template <typename Entity>
 Level<Entity>::Level(const sf::Vector2i& size)
 	: Map(size)
@@ -44,8 +56,9 @@ template <typename T>
 void Level<Entity>::attachBack(std::unique_ptr<T> entity)
 {
 	const std::size_t id = getId<T>();
+	const Entity* pointer = entity.get();
 
-	m_layers[id].emplace_back(std::move(entity));
+	m_handles[pointer] = { m_layers[id].insert(std::move(entity)), id };
 }
 
 template <typename Entity>
@@ -53,8 +66,9 @@ template <typename T>
 void Level<Entity>::attachFront(std::unique_ptr<T> entity)
 {
 	const std::size_t id = getId<T>();
+	const Entity* pointer = entity.get();
 
-	m_layers[id].insert(m_layers[id].begin(), std::move(entity));
+	m_handles[pointer] = { m_layers[id].insertFront(std::move(entity)), id };
 }
 
 template <typename Entity>
@@ -64,17 +78,50 @@ std::unique_ptr<T> Level<Entity>::detach(Entity& entity)
 	const std::size_t id = getId<T>();
 	EntityLayer& layer = m_layers[id];
 
-	const auto found = std::find_if(layer.begin(), layer.end(),
-		[&] (const auto& e) { return e.get() == &entity; });
-	assert(found != layer.end());
+	const auto found = m_handles.find(&entity);
+	assert(found != m_handles.end());
+	assert(found->second.layer == id);
 
-	// auto result = std::move(*found);
-	auto result = std::unique_ptr<T>(static_cast<T*>(found->release()));
-	layer.erase(found);
+	// NOTE: the hole is compacted by removeWrecks
+	auto result = std::unique_ptr<T>(static_cast<T*>(layer[found->second.slot].release()));
+	layer.erase(found->second.slot);
+	m_handles.erase(found);
 
 	return result;
 }
 
+template <typename Entity>
+typename Level<Entity>::Handle Level<Entity>::getHandle(const Entity& entity) const
+{
+	const auto found = m_handles.find(&entity);
+
+	if (found == m_handles.end())
+		return {};
+
+	return found->second;
+}
+
+template <typename Entity>
+template <typename T>
+T* Level<Entity>::resolve(const Handle& handle) const
+{
+	const std::size_t id = getId<T>();
+
+	if (handle.layer != id)
+	{
+		// NOTE: the entity was attached as another type, the slot would resolve to an entity of the wrong layer
+		assert(handle == Handle());
+		return nullptr;
+	}
+
+	const auto* entity = m_layers[id].get(handle.slot);
+
+	if (!entity)
+		return nullptr;
+
+	return static_cast<T*>(entity->get());
+}
+
 template <typename Entity>
 template <typename T>
 bool Level<Entity>::isEmpty() const
@@ -176,8 +223,16 @@ template <typename Entity>
 void Level<Entity>::removeWrecks()
 {
 	for (auto& layer : m_layers)
-		layer.erase(std::remove_if(layer.begin(), layer.end(),
-			std::mem_fn(&Entity::isMarkedForRemoval)), layer.end());
+	{
+		layer.eraseIf([&] (const auto& entity)
+		{
+			if (!entity->isMarkedForRemoval())
+				return false;
+
+			m_handles.erase(entity.get());
+			return true;
+		});
+	}
 }
 
 }
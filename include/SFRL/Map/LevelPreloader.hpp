@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../Rng.hpp"
+
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace rl
+{
+
+// generates the next level on a background thread
+// NOTE: the builder must only use the given rng to get the same level as build(),
+//       entity layers should be registered with Level::addLayer() before preloading
+template <typename Level>
+class LevelPreloader
+{
+public:
+	using Ptr = std::unique_ptr<Level>;
+	using Builder = std::function<Ptr(int depth, Rng& rng)>;
+
+public:
+	LevelPreloader(Builder builder, unsigned int seed);
+	~LevelPreloader();
+
+	LevelPreloader(const LevelPreloader&) = delete;
+	LevelPreloader& operator=(const LevelPreloader&) = delete;
+
+	void preload(int depth);
+	bool isPreloading(int depth) const;
+	bool isReady() const;
+
+	Ptr build(int depth) const; // synchronous
+	Ptr get(int depth);         // waits for the preloaded level, or builds it
+
+private:
+	Builder m_builder;
+	unsigned int m_seed;
+	int m_depth = 0;
+	std::future<Ptr> m_future;
+};
+
+}
+
+#include "LevelPreloader.inl"
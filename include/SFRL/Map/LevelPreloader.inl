@@ -0,0 +1,66 @@
+namespace rl
+{
+
+template <typename Level>
+LevelPreloader<Level>::LevelPreloader(Builder builder, unsigned int seed)
+	: m_builder(std::move(builder))
+	, m_seed(seed)
+{
+}
+
+template <typename Level>
+LevelPreloader<Level>::~LevelPreloader()
+{
+	if (m_future.valid())
+		m_future.wait();
+}
+
+template <typename Level>
+void LevelPreloader<Level>::preload(int depth)
+{
+	if (isPreloading(depth))
+		return;
+
+	if (m_future.valid())
+		m_future.wait();
+
+	m_depth = depth;
+	m_future = std::async(std::launch::async, [this, depth] () { return build(depth); });
+}
+
+template <typename Level>
+bool LevelPreloader<Level>::isPreloading(int depth) const
+{
+	return m_future.valid() && m_depth == depth;
+}
+
+template <typename Level>
+bool LevelPreloader<Level>::isReady() const
+{
+	return m_future.valid() && m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+template <typename Level>
+typename LevelPreloader<Level>::Ptr LevelPreloader<Level>::build(int depth) const
+{
+	// each depth has its own rng, the level does not depend on when it was built
+	Rng rng(m_seed, static_cast<unsigned int>(depth));
+
+	return m_builder(depth, rng);
+}
+
+template <typename Level>
+typename LevelPreloader<Level>::Ptr LevelPreloader<Level>::get(int depth)
+{
+	if (isPreloading(depth))
+		return m_future.get();
+
+	if (m_future.valid())
+		m_future.wait();
+
+	m_future = {};
+
+	return build(depth);
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "MapGenerator.hpp"
+
+#include <SFML/System/Time.hpp>
+
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+namespace rl
+{
+
+// headless batch map generation on worker threads
+class MapBatch
+{
+public:
+	// NOTE: the factory is called from worker threads
+	using Factory = std::function<std::unique_ptr<MapGenerator>()>;
+
+	struct Result
+	{
+		unsigned int seed = 0;
+		std::uint64_t hash = 0;  // tiles and flags
+		float floorRatio = 0.f;  // passable tiles / all tiles
+		int regionCount = 0;     // passable regions (cardinal)
+		sf::Time time;           // total generation time
+		std::vector<MapGenerator::Stage> stages;
+	};
+
+public:
+	MapBatch(Factory factory, const sf::Vector2i& mapSize);
+
+	MapBatch(const MapBatch&) = delete;
+	MapBatch& operator=(const MapBatch&) = delete;
+
+	unsigned int getThreadCount() const;
+	void setThreadCount(unsigned int count); // 0: all cores
+
+	Result generate(unsigned int seed) const;
+	Result generate(unsigned int seed, Map& map) const;
+
+	// seeds [firstSeed, firstSeed + count), results are sorted by seed
+	std::vector<Result> run(unsigned int firstSeed, unsigned int count) const;
+	std::vector<Result> run(unsigned int firstSeed, unsigned int count, unsigned int threadCount) const;
+
+	// returns the seeds whose maps differ on re-run or with a single thread
+	std::vector<unsigned int> verify(unsigned int firstSeed, unsigned int count) const;
+
+	static std::uint64_t hash(const Map& map);
+	static int countRegions(const Map& map);
+
+private:
+	Factory m_factory;
+	sf::Vector2i m_mapSize;
+	unsigned int m_threadCount = 0;
+};
+
+}
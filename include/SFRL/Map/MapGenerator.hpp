@@ -3,6 +3,14 @@
 #include "Map.hpp"
 #include "../Rng.hpp"
 
+#include <SFML/System/Time.hpp>
+
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
 namespace rl
 {
 
@@ -19,6 +27,39 @@ public:
 		Winding,  // river
 	};
 
+	struct Stage
+	{
+		std::string name;
+		sf::Time time;
+		int changedTiles = 0;
+		bool cached = false;
+	};
+
+	// intermediate results keyed by generator, seed, map size and stage names
+	class StageCache
+	{
+	public:
+		struct Entry
+		{
+			std::vector<Tile> tiles;
+			Rng rng;
+			int changedTiles;
+		};
+
+		using EntryPtr = std::shared_ptr<const Entry>;
+
+	public:
+		EntryPtr find(const std::string& key) const;
+		void insert(const std::string& key, EntryPtr entry);
+
+		void clear();
+		std::size_t getSize() const;
+
+	private:
+		mutable std::mutex m_mutex;
+		std::unordered_map<std::string, EntryPtr> m_entries;
+	};
+
 public:
 	MapGenerator() = default;
 	virtual ~MapGenerator() = default;
@@ -28,7 +69,18 @@ public:
 
 	void generate(Map& map, Rng& rng);
 
+	// timings of the last generate() call
+	const std::vector<Stage>& getStages() const;
+
+	// NOTE: the cache assumes that generate() is called with a freshly seeded rng
+	void setStageCache(StageCache* cache);
+
 protected:
+	// runs a named step of onGenerate(), a cached step restores the tiles and the rng instead
+	// NOTE: steps that produce anything other than tiles should not be cacheable,
+	//       the name should include the parameters of the step
+	void stage(const std::string& name, const std::function<void()>& step, bool cacheable = true);
+
 	void fill(Tile tile);
 	void fill(int wallProb);
 
@@ -62,7 +114,7 @@ protected:
 	void carvePath(const Point& from, const Point& to, bool widePassage = true);
 	void carveCircle(const Point& center, int radius);
 	void carveCorridor(const Point& from, const Point& to);
-	void carveWindingRoad(const Point& from, const Point& to, bool widePassage = true, int perturbation = 10);
+	void carveWindingRoad(const Point& from, const Point& to, bool widePassage = true, int perturbation = 10, const Room& area = {}); // the road bends within area (empty: the map)
 	void extendLine(Point& from, Point& to);
 
 	void erode(int iterations);
@@ -72,6 +124,8 @@ protected:
 	void removeUnusedWalls(); // remove unseen walls
 
 private:
+	void initializeFlags();
+
 	virtual void onGenerate() = 0;
 	virtual void onDecorate() = 0;
 
@@ -98,6 +152,11 @@ protected:
 	Tile m_water    = Tile::Water;
 	Tile m_bridge   = Tile::Bridge;
 	// chasm?
+
+private:
+	std::vector<Stage> m_stages;
+	StageCache* m_cache = nullptr;
+	std::string m_stageKey;
 };
 
 }
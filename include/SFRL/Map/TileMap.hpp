@@ -1,15 +1,21 @@
 #pragma once
 
+#include "Tileset.hpp"
+
 #include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexBuffer.hpp>
 
 #include <vector>
+#include <memory>
 
 namespace rl
 {
 
 class Map;
+class SoftwareTarget;
 
 class TileMap : public sf::Drawable, public sf::Transformable
 {
@@ -24,36 +30,108 @@ public:
 public:
 	TileMap() = default;
 	TileMap(const sf::Texture& texture, const sf::Vector2i& tileSize);
+	explicit TileMap(const Tileset& tileset);
 
 	TileMap(const TileMap&) = delete;
 	TileMap& operator=(const TileMap&) = delete;
 
 	void setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize);
+	void setTileset(const Tileset& tileset); // NOTE: not copied
 	void setMap(Map& map);
 	void setViewRect(const sf::IntRect& rect);
 
 	void setTiles(const std::vector<int>& tiles);
-	void setProps(const std::vector<Prop>& props);
 	void setFovHack(bool flag);
 
+	// darkens the tiles and props out of sight with the vertex colors, in the same pass
+	// NOTE: replaces a Fov without texture, use a textured Fov on top for the soft edges
+	void setShading(bool flag);
+
+	// draws each chunk in view to a render texture, then a single quad per chunk until its tiles change
+	// NOTE: with shading, the cached tiles are not shaded, the shading of the tiles is drawn over them
+	//       as untextured quads, so that the visible tiles can change without rendering the chunks again
+	void setCaching(bool flag);
+
+	// NOTE: props is kept (not copied) and read again by updateTileMap, as the tiles; also removes the added props
+	void setProps(const std::vector<Prop>& props);
+
+	// props owned by the tile map, drawn over the props of setProps
+	// NOTE: removeProp only removes the added props, clearProps removes both
+	void addProp(const Prop& prop);
+	bool removeProp(const sf::Vector2i& position, int tileNumber);
+	void clearProps();
+
+	// NOTE: only the chunks with changed tiles or explored flags are rebuilt
 	void updateTileMap();
+	void updateTile(const sf::Vector2i& position);
+
+	// CPU rendering for benchmarks and regression tests
+	void draw(SoftwareTarget& target, sf::RenderStates states = sf::RenderStates::Default) const;
+
+	static constexpr int ChunkSize = 16;
 
 private:
-	void appendQuad(const sf::Vector2i& position, int tileNumber, const sf::Vector2f& offset) const;
-	void updateVertices() const;
+	struct Chunk
+	{
+		sf::IntRect rect;
+		std::vector<int> tiles; // drawn tile numbers, -1 if not explored
+		std::vector<int> shades;
+		std::vector<sf::Vertex> vertices;
+		std::vector<sf::Vertex> shadeVertices; // shading over the tiles with caching
+		sf::VertexBuffer buffer;
+		std::unique_ptr<sf::RenderTexture> cache; // only while in view
+		std::vector<Prop> props;              // from setProps (linkedCount first), then added
+		std::size_t linkedCount = 0;
+		std::vector<sf::Vertex> propVertices; // explored props, in the order of props
+		std::vector<int> propIndices;         // first vertex of each prop, -1 if not explored
+		bool needsCheck = true;
+		bool needsUpdate = true;
+		bool propsNeedUpdate = true;
+		bool shadesNeedUpdate = true;
+		bool cacheNeedsUpdate = true;
+	};
+
+	void createChunks();
+	void linkProps();
+	void invalidateChunks();
+	Chunk& getChunk(const sf::Vector2i& position) const;
+	int getShade(int x, int y) const;
+	void checkChunk(Chunk& chunk) const;
+	void updateChunk(Chunk& chunk) const;
+	void updateProps(Chunk& chunk) const;
+	void updateShades(Chunk& chunk) const;
+	bool isShadingOver() const;
+
+	void releaseCaches(int left, int top, int right, int bottom) const;
+	bool drawCachedChunk(Chunk& chunk, sf::RenderTarget& target, const sf::RenderStates& states) const;
+
+	template <typename Target>
+	void drawChunk(const Chunk& chunk, Target& target, const sf::RenderStates& states) const;
+
+	template <typename Target>
+	void render(Target& target, sf::RenderStates states) const;
+
+	void appendQuad(std::vector<sf::Vertex>& vertices, const sf::Vector2i& position, int tileNumber, const sf::Vector2f& offset, const sf::Color& color) const;
 
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
 private:
-	const sf::Texture* m_texture = nullptr;
+	Tileset m_defaultTileset; // setTexture
+	const Tileset* m_tileset = nullptr;
 	sf::Vector2i m_tileSize;
 	const Map* m_map = nullptr;
 	const std::vector<int>* m_tiles = nullptr; // background
 	const std::vector<Prop>* m_props = nullptr; // foreground
 	sf::IntRect m_viewRect;
 	bool m_fovHack = false;
-	mutable std::vector<sf::Vertex> m_vertices;
-	mutable bool m_verticesNeedUpdate = false;
+	bool m_shading = false;
+	bool m_useVertexBuffer = false;
+	bool m_caching = false;
+	sf::Vector2i m_chunkCount;
+	mutable std::vector<Chunk> m_chunks;
+	std::vector<Prop> m_pendingProps; // added before setMap
+	mutable std::vector<std::unique_ptr<sf::RenderTexture>> m_cachePool; // released by chunks out of view
+	mutable std::vector<sf::Vertex> m_vertices; // props or shading in view
 };
 
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <array>
+#include <vector>
+
+namespace sf
+{
+	class Texture;
+}
+
+namespace rl
+{
+
+// texture coordinates of every tile, shared by TileMap and Fov
+// several sheets (padded or not) can be packed into one texture, their tile numbers follow each other
+class Tileset
+{
+public:
+	// top-left, top-right, bottom-right, bottom-left (same order as the quad vertices)
+	using TexCoords = std::array<sf::Vector2f, 4>;
+
+public:
+	Tileset() = default;
+	Tileset(const sf::Texture& texture, const sf::Vector2i& tileSize);
+
+	void setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize);
+	const sf::Texture* getTexture() const;
+	const sf::Vector2i& getTileSize() const;
+
+	// returns the tile number of the first tile of the sheet
+	// NOTE: the whole texture if area is empty, padding is the space between the tiles
+	int addSheet(const sf::IntRect& area = {}, int padding = 0);
+	void clear();
+
+	int getTileCount() const;
+	const TexCoords& getTexCoords(int tileNumber) const; // NOTE: out of range tiles get empty coordinates
+
+private:
+	const sf::Texture* m_texture = nullptr;
+	sf::Vector2i m_tileSize;
+	std::vector<TexCoords> m_texCoords;
+};
+
+}
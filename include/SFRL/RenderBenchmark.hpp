@@ -0,0 +1,52 @@
+#pragma once
+
+#include "SoftwareTarget.hpp"
+
+#include <SFML/System/Time.hpp>
+
+#include <functional>
+#include <ostream>
+#include <vector>
+#include <cstdint>
+
+namespace rl
+{
+
+// times scripted frames on a SoftwareTarget, e.g. a camera path over a TileMap and a Fov
+// NOTE: the hashes of a run can be kept and compared to catch rendering regressions
+class RenderBenchmark
+{
+public:
+	struct Frame
+	{
+		sf::Time update; // frame script (camera, fov, console)
+		sf::Time build;  // draw calls without the rasterization (vertex updates)
+		sf::Time raster;
+		std::uint64_t hash = 0;
+	};
+
+	using Script = std::function<void(int frame)>;
+	using Draw = std::function<void(SoftwareTarget& target)>;
+
+public:
+	explicit RenderBenchmark(const sf::Vector2u& size);
+
+	SoftwareTarget& getTarget();
+
+	const std::vector<Frame>& run(int frameCount, const Script& script, const Draw& draw, const sf::Color& clearColor = sf::Color::Black);
+
+	const std::vector<Frame>& getFrames() const;
+	Frame getAverage() const; // hash of the last frame
+	std::vector<std::uint64_t> getHashes() const;
+
+	// index of the first frame with a different hash, -1 if all frames match
+	int compare(const std::vector<std::uint64_t>& hashes) const;
+
+	void print(std::ostream& stream) const;
+
+private:
+	SoftwareTarget m_target;
+	std::vector<Frame> m_frames;
+};
+
+}
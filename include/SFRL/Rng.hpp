@@ -14,6 +14,7 @@ class Rng
 {
 public:
 	explicit Rng(unsigned int seed = std::random_device()());
+	Rng(unsigned int seed, unsigned int stream); // independent substream of the seed
 
 	int getSeed() const;
 	void printSeed() const;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+namespace rl
+{
+
+// keeps the values in insertion order, a handle is valid until its value is erased
+// NOTE: erase leaves a hole (skipped by the iterators), compact() removes the holes
+template <typename T>
+class SlotMap
+{
+public:
+	struct Handle
+	{
+		std::uint32_t index = Invalid;
+		std::uint32_t generation = 0;
+
+		bool operator==(const Handle& other) const;
+		bool operator!=(const Handle& other) const;
+	};
+
+	template <typename Map, typename Value>
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Value*;
+		using reference = Value&;
+
+	public:
+		Iterator(Map& map, std::size_t position);
+
+		Value& operator*() const;
+		Value* operator->() const;
+		Iterator& operator++();
+
+		bool operator==(const Iterator& other) const;
+		bool operator!=(const Iterator& other) const;
+
+	private:
+		void skipHoles();
+
+	private:
+		Map* m_map;
+		std::size_t m_position;
+	};
+
+	using iterator = Iterator<SlotMap, T>;
+	using const_iterator = Iterator<const SlotMap, const T>;
+
+public:
+	Handle insert(T value);
+	Handle insertFront(T value);
+	bool erase(const Handle& handle);
+
+	template <typename Predicate>
+	std::size_t eraseIf(Predicate predicate);
+
+	void compact();
+	void clear();
+
+	bool contains(const Handle& handle) const;
+	T* get(const Handle& handle);
+	const T* get(const Handle& handle) const;
+	T& operator[](const Handle& handle);
+	const T& operator[](const Handle& handle) const;
+
+	std::size_t size() const;
+	bool empty() const;
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	struct Slot
+	{
+		std::uint32_t position = Invalid; // in m_values, or the next free slot
+		std::uint32_t generation = 0;
+	};
+
+	static constexpr std::uint32_t Invalid = static_cast<std::uint32_t>(-1);
+
+private:
+	std::vector<T> m_values;
+	std::vector<std::uint32_t> m_owners; // slot of each value, Invalid for a hole
+	std::vector<Slot> m_slots;
+	std::uint32_t m_freeSlot = Invalid;
+	std::size_t m_size = 0;
+};
+
+}
+
+#include "SlotMap.inl"
@@ -0,0 +1,266 @@
+namespace rl
+{
+
+template <typename T>
+bool SlotMap<T>::Handle::operator==(const Handle& other) const
+{
+	return index == other.index && generation == other.generation;
+}
+
+template <typename T>
+bool SlotMap<T>::Handle::operator!=(const Handle& other) const
+{
+	return !(*this == other);
+}
+
+template <typename T>
+template <typename Map, typename Value>
+SlotMap<T>::Iterator<Map, Value>::Iterator(Map& map, std::size_t position)
+	: m_map(&map)
+	, m_position(position)
+{
+	skipHoles();
+}
+
+template <typename T>
+template <typename Map, typename Value>
+Value& SlotMap<T>::Iterator<Map, Value>::operator*() const
+{
+	return m_map->m_values[m_position];
+}
+
+template <typename T>
+template <typename Map, typename Value>
+Value* SlotMap<T>::Iterator<Map, Value>::operator->() const
+{
+	return &m_map->m_values[m_position];
+}
+
+template <typename T>
+template <typename Map, typename Value>
+typename SlotMap<T>::template Iterator<Map, Value>& SlotMap<T>::Iterator<Map, Value>::operator++()
+{
+	++m_position;
+	skipHoles();
+
+	return *this;
+}
+
+template <typename T>
+template <typename Map, typename Value>
+bool SlotMap<T>::Iterator<Map, Value>::operator==(const Iterator& other) const
+{
+	return m_position == other.m_position;
+}
+
+template <typename T>
+template <typename Map, typename Value>
+bool SlotMap<T>::Iterator<Map, Value>::operator!=(const Iterator& other) const
+{
+	return m_position != other.m_position;
+}
+
+template <typename T>
+template <typename Map, typename Value>
+void SlotMap<T>::Iterator<Map, Value>::skipHoles()
+{
+	while (m_position < m_map->m_owners.size() && m_map->m_owners[m_position] == Invalid)
+		++m_position;
+}
+
+template <typename T>
+typename SlotMap<T>::Handle SlotMap<T>::insert(T value)
+{
+	std::uint32_t index = m_freeSlot;
+
+	if (index != Invalid)
+		m_freeSlot = m_slots[index].position;
+	else
+	{
+		index = static_cast<std::uint32_t>(m_slots.size());
+		m_slots.emplace_back();
+	}
+
+	Slot& slot = m_slots[index];
+	slot.position = static_cast<std::uint32_t>(m_values.size());
+
+	m_values.emplace_back(std::move(value));
+	m_owners.emplace_back(index);
+	++m_size;
+
+	return { index, slot.generation };
+}
+
+template <typename T>
+typename SlotMap<T>::Handle SlotMap<T>::insertFront(T value)
+{
+	const Handle handle = insert(std::move(value));
+
+	// NOTE: O(n), every value moves one position
+	std::rotate(m_values.begin(), m_values.end() - 1, m_values.end());
+	std::rotate(m_owners.begin(), m_owners.end() - 1, m_owners.end());
+
+	for (std::size_t i = 0; i < m_owners.size(); ++i)
+	{
+		if (m_owners[i] != Invalid)
+			m_slots[m_owners[i]].position = static_cast<std::uint32_t>(i);
+	}
+
+	return handle;
+}
+
+template <typename T>
+bool SlotMap<T>::erase(const Handle& handle)
+{
+	if (!contains(handle))
+		return false;
+
+	Slot& slot = m_slots[handle.index];
+
+	m_values[slot.position] = T();
+	m_owners[slot.position] = Invalid;
+
+	// invalidate the handles
+	++slot.generation;
+	slot.position = m_freeSlot;
+	m_freeSlot = handle.index;
+	--m_size;
+
+	return true;
+}
+
+template <typename T>
+template <typename Predicate>
+std::size_t SlotMap<T>::eraseIf(Predicate predicate)
+{
+	const std::size_t size = m_size;
+	std::size_t count = 0;
+
+	// NOTE: compacts in the same pass
+	for (std::size_t i = 0; i < m_values.size(); ++i)
+	{
+		const std::uint32_t index = m_owners[i];
+
+		if (index == Invalid)
+			continue;
+
+		if (predicate(m_values[i]))
+		{
+			erase({ index, m_slots[index].generation });
+			continue;
+		}
+
+		if (count != i)
+		{
+			m_values[count] = std::move(m_values[i]);
+			m_owners[count] = index;
+			m_slots[index].position = static_cast<std::uint32_t>(count);
+		}
+
+		++count;
+	}
+
+	m_values.resize(count);
+	m_owners.resize(count);
+
+	return size - m_size;
+}
+
+template <typename T>
+void SlotMap<T>::compact()
+{
+	if (m_values.size() != m_size)
+		eraseIf([] (const T&) { return false; });
+}
+
+template <typename T>
+void SlotMap<T>::clear()
+{
+	for (std::size_t i = 0; i < m_owners.size(); ++i)
+	{
+		if (m_owners[i] != Invalid)
+			erase({ m_owners[i], m_slots[m_owners[i]].generation });
+	}
+
+	m_values.clear();
+	m_owners.clear();
+}
+
+template <typename T>
+bool SlotMap<T>::contains(const Handle& handle) const
+{
+	return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+}
+
+template <typename T>
+T* SlotMap<T>::get(const Handle& handle)
+{
+	if (!contains(handle))
+		return nullptr;
+
+	return &m_values[m_slots[handle.index].position];
+}
+
+template <typename T>
+const T* SlotMap<T>::get(const Handle& handle) const
+{
+	if (!contains(handle))
+		return nullptr;
+
+	return &m_values[m_slots[handle.index].position];
+}
+
+template <typename T>
+T& SlotMap<T>::operator[](const Handle& handle)
+{
+	// NOTE: the value was erased (dangling handle)
+	assert(contains(handle));
+
+	return m_values[m_slots[handle.index].position];
+}
+
+template <typename T>
+const T& SlotMap<T>::operator[](const Handle& handle) const
+{
+	assert(contains(handle));
+
+	return m_values[m_slots[handle.index].position];
+}
+
+template <typename T>
+std::size_t SlotMap<T>::size() const
+{
+	return m_size;
+}
+
+template <typename T>
+bool SlotMap<T>::empty() const
+{
+	return m_size == 0;
+}
+
+template <typename T>
+typename SlotMap<T>::iterator SlotMap<T>::begin()
+{
+	return { *this, 0 };
+}
+
+template <typename T>
+typename SlotMap<T>::iterator SlotMap<T>::end()
+{
+	return { *this, m_values.size() };
+}
+
+template <typename T>
+typename SlotMap<T>::const_iterator SlotMap<T>::begin() const
+{
+	return { *this, 0 };
+}
+
+template <typename T>
+typename SlotMap<T>::const_iterator SlotMap<T>::end() const
+{
+	return { *this, m_values.size() };
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace sf
+{
+	class Image;
+	class Texture;
+}
+
+namespace rl
+{
+
+// CPU render target (RGBA buffer) for benchmarks and regression tests without a display
+// TileMap, Fov and Console can draw on it with their draw(SoftwareTarget&) overloads
+class SoftwareTarget
+{
+public:
+	SoftwareTarget() = default;
+	explicit SoftwareTarget(const sf::Vector2u& size);
+
+	void create(const sf::Vector2u& size);
+	const sf::Vector2u& getSize() const;
+
+	// NOTE: the image is not copied, textures without image are sampled as white
+	void setImage(const sf::Texture& texture, const sf::Image& image);
+
+	void clear(const sf::Color& color = sf::Color::Black);
+
+	// quads and triangles, alpha blended, nearest texture sampling
+	void draw(const sf::Vertex* vertices, std::size_t vertexCount, sf::PrimitiveType type, const sf::RenderStates& states = sf::RenderStates::Default);
+
+	sf::Color getPixel(unsigned int x, unsigned int y) const;
+	const sf::Uint8* getPixels() const;
+	std::uint64_t getHash() const;
+	void copyToImage(sf::Image& image) const;
+
+	// time spent in draw since the last clear
+	sf::Time getRasterTime() const;
+
+private:
+	void drawTriangle(const sf::Vertex& v0, const sf::Vertex& v1, const sf::Vertex& v2, const sf::Image* image);
+
+private:
+	sf::Vector2u m_size;
+	std::vector<sf::Uint8> m_pixels;
+	std::unordered_map<const sf::Texture*, const sf::Image*> m_images;
+	sf::Time m_rasterTime;
+};
+
+}
@@ -30,6 +30,14 @@ public:
 	virtual bool handleEvent(const sf::Event& event) = 0;
 	virtual bool update(sf::Time dt) = 0;
 
+	// covers the whole target, the states below are not drawn
+	virtual bool isOpaque() const;
+
+	// the states below are drawn once into a texture, then the texture until the stack changes
+	// or one of them is updated or handles an event
+	// NOTE: for translucent overlays, update should return false to pause the states below
+	virtual bool isCachingBelow() const;
+
 	void setStateStack(StateStack& stack);
 
 protected:
@@ -38,6 +46,7 @@ protected:
 
 	void popState();
 	void clearStates();
+	void invalidateCache(); // a cached state changed outside of update
 
 private:
 	void pushState(State::Ptr state);
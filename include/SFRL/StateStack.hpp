@@ -2,6 +2,9 @@
 
 #include "State.hpp"
 
+#include <SFML/Graphics/RenderTexture.hpp>
+
+#include <memory>
 #include <vector>
 
 namespace rl
@@ -21,6 +24,9 @@ public:
 	void popState();
 	void clearStates();
 
+	// draws the states below a caching state again on the next draw
+	void invalidateCache();
+
 	void handleEvent(const sf::Event& event);
 	void update(sf::Time dt);
 
@@ -34,11 +40,16 @@ private:
 
 	void applyPendingChanges();
 
+	bool drawCache(sf::RenderTarget& target, const sf::RenderStates& states, std::size_t first, std::size_t last) const;
+
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
 private:
 	std::vector<State::Ptr> m_stack;
 	std::vector<std::pair<Action, State::Ptr>> m_pendingList;
+	mutable std::unique_ptr<sf::RenderTexture> m_cache; // states below a caching state, created on first use
+	mutable std::size_t m_cachedFirst = 0;
+	mutable std::size_t m_cachedLast = 0;               // 0 if the cache is not valid
 };
 
 }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rl
+{
+
+class Console;
+
+// draws a console on an ANSI/VT100 terminal (24-bit colors), e.g. for remote play without a display
+// NOTE: only the cells changed since the last frame are written, with one write per frame
+class Terminal
+{
+public:
+	explicit Terminal(std::ostream& stream);
+	~Terminal();
+
+	Terminal(const Terminal&) = delete;
+	Terminal& operator=(const Terminal&) = delete;
+
+	void present(const Console& console);
+	void invalidate(); // redraws every cell on the next frame (e.g. new connection)
+
+	std::size_t getFrameSize() const; // bytes written by the last frame
+
+private:
+	struct Cell
+	{
+		bool operator==(const Cell& cell) const;
+		bool operator!=(const Cell& cell) const;
+
+		wchar_t ch = 0;
+		sf::Color text;
+		sf::Color background;
+	};
+
+	Cell getCell(const Console& console, int x, int y) const;
+
+	void moveTo(int x, int y);
+	void setColors(const sf::Color& text, const sf::Color& background);
+	void appendChar(wchar_t ch);
+	void appendColor(const char* prefix, const sf::Color& color);
+
+private:
+	std::ostream& m_stream;
+	sf::Vector2i m_size;
+	std::vector<Cell> m_cells; // on the terminal
+	std::string m_buffer;
+	sf::Vector2i m_cursor = { -1, -1 }; // -1 if unknown
+	sf::Color m_text;
+	sf::Color m_background;
+	bool m_colorsKnown = false;
+	bool m_needsClear = true;
+	std::size_t m_frameSize = 0;
+};
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+namespace rl
+{
+
+// threads kept alive for short parallel jobs (e.g. the decisions of one tick), the caller takes part in each job
+class WorkerPool
+{
+public:
+	explicit WorkerPool(unsigned int threadCount); // including the caller
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	unsigned int getThreadCount() const;
+
+	// calls work once on every thread and returns when all the calls returned
+	// NOTE: work shares the job itself (e.g. an atomic index), one call per thread
+	void run(const std::function<void()>& work);
+
+private:
+	void loop();
+
+private:
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_started;
+	std::condition_variable m_finished;
+	const std::function<void()>* m_work = nullptr;
+	std::size_t m_job = 0;     // incremented for each job
+	std::size_t m_running = 0; // threads still working on the job
+	bool m_stopping = false;
+};
+
+}
@@ -1,6 +1,138 @@
 #include "Action/Action.hpp"
 #include "StateStack.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+	constexpr std::size_t BlockSize = 16;
+	constexpr std::size_t ClassCount = 16; // up to 256 bytes, larger actions use the heap
+	constexpr std::size_t BlocksPerChunk = 64;
+	constexpr std::size_t MaxCachedBlocks = BlocksPerChunk * 2; // per size class and thread
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	struct FreeList
+	{
+		FreeBlock* head = nullptr;
+		std::size_t count = 0;
+
+		void push(FreeBlock* block)
+		{
+			block->next = head;
+			head = block;
+			++count;
+		}
+
+		FreeBlock* pop()
+		{
+			FreeBlock* block = head;
+			head = block->next;
+			--count;
+
+			return block;
+		}
+	};
+
+	struct ActionPool
+	{
+		// NOTE: only locked to refill or flush a thread cache, actions are created by the decisions on worker threads
+		std::mutex mutex;
+		std::array<FreeList, ClassCount> freeLists;
+		std::atomic<std::size_t> allocationCount = 0;
+		std::atomic<std::size_t> liveCount = 0;
+	};
+
+	ActionPool& getPool()
+	{
+		// NOTE: never destroyed, the chunks are kept for the whole program
+		static ActionPool* pool = new ActionPool();
+
+		return *pool;
+	}
+
+	void allocateChunk(FreeList& freeList, std::size_t sizeClass)
+	{
+		const std::size_t blockSize = (sizeClass + 1) * BlockSize;
+		auto* chunk = static_cast<unsigned char*>(::operator new(blockSize * BlocksPerChunk));
+		getPool().allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+		for (std::size_t i = 0; i < BlocksPerChunk; ++i)
+			freeList.push(reinterpret_cast<FreeBlock*>(chunk + i * blockSize));
+	}
+
+	// moves up to count blocks from one list to the other
+	void moveBlocks(FreeList& from, FreeList& to, std::size_t count)
+	{
+		for (; count > 0 && from.head; --count)
+			to.push(from.pop());
+	}
+
+	thread_local bool t_cacheDestroyed = false;
+
+	struct ThreadCache
+	{
+		std::array<FreeList, ClassCount> freeLists;
+
+		~ThreadCache()
+		{
+			t_cacheDestroyed = true;
+
+			// NOTE: the blocks of a finished thread go back to the other threads
+			ActionPool& pool = getPool();
+			std::lock_guard<std::mutex> lock(pool.mutex);
+
+			for (std::size_t i = 0; i < ClassCount; ++i)
+				moveBlocks(freeLists[i], pool.freeLists[i], freeLists[i].count);
+		}
+
+		void refill(std::size_t sizeClass)
+		{
+			ActionPool& pool = getPool();
+			FreeList& freeList = freeLists[sizeClass];
+
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex);
+				moveBlocks(pool.freeLists[sizeClass], freeList, BlocksPerChunk);
+			}
+
+			if (!freeList.head)
+				allocateChunk(freeList, sizeClass);
+		}
+
+		void flush(std::size_t sizeClass)
+		{
+			// NOTE: the actions decided on other threads are deleted here, the surplus goes back to the pool
+			ActionPool& pool = getPool();
+			std::lock_guard<std::mutex> lock(pool.mutex);
+
+			moveBlocks(freeLists[sizeClass], pool.freeLists[sizeClass], BlocksPerChunk);
+		}
+	};
+
+	// NOTE: nullptr once destroyed (actions deleted by static destructors), the pool is then used directly
+	ThreadCache* getThreadCache()
+	{
+		if (t_cacheDestroyed)
+			return nullptr;
+
+		thread_local ThreadCache cache;
+
+		return &cache;
+	}
+
+	std::size_t getSizeClass(std::size_t size)
+	{
+		return (std::max<std::size_t>(size, 1) + BlockSize - 1) / BlockSize - 1;
+	}
+}
+
 namespace rl
 {
 
@@ -12,6 +144,78 @@ bool Action::isDone() const
 	return true;
 }
 
+void* Action::operator new(std::size_t size)
+{
+	ActionPool& pool = getPool();
+	const std::size_t sizeClass = getSizeClass(size);
+
+	pool.liveCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (sizeClass >= ClassCount)
+	{
+		pool.allocationCount.fetch_add(1, std::memory_order_relaxed);
+		return ::operator new(size);
+	}
+
+	ThreadCache* cache = getThreadCache();
+
+	if (!cache)
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+
+		if (!pool.freeLists[sizeClass].head)
+			allocateChunk(pool.freeLists[sizeClass], sizeClass);
+
+		return pool.freeLists[sizeClass].pop();
+	}
+
+	if (!cache->freeLists[sizeClass].head)
+		cache->refill(sizeClass);
+
+	return cache->freeLists[sizeClass].pop();
+}
+
+void Action::operator delete(void* pointer, std::size_t size)
+{
+	if (!pointer)
+		return;
+
+	ActionPool& pool = getPool();
+	const std::size_t sizeClass = getSizeClass(size);
+
+	pool.liveCount.fetch_sub(1, std::memory_order_relaxed);
+
+	if (sizeClass >= ClassCount)
+	{
+		::operator delete(pointer);
+		return;
+	}
+
+	ThreadCache* cache = getThreadCache();
+
+	if (!cache)
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.freeLists[sizeClass].push(static_cast<FreeBlock*>(pointer));
+		return;
+	}
+
+	cache->freeLists[sizeClass].push(static_cast<FreeBlock*>(pointer));
+
+	if (cache->freeLists[sizeClass].count > MaxCachedBlocks)
+		cache->flush(sizeClass);
+}
+
+std::size_t Action::getAllocationCount()
+{
+	return getPool().allocationCount.load(std::memory_order_relaxed);
+}
+
+std::size_t Action::getLiveCount()
+{
+	return getPool().liveCount.load(std::memory_order_relaxed);
+}
+
 void Action::setWorld(World& world)
 {
 	s_world = &world;
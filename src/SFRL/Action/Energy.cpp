@@ -68,12 +68,29 @@ bool Energy::gainEnergy()
 	return canTakeTurn();
 }
 
+bool Energy::gainEnergy(int ticks)
+{
+	m_energy += Gains[m_speed + Normal] * ticks;
+
+	return canTakeTurn();
+}
+
 void Energy::spendEnergy()
 {
 	// assert(m_energy >= ActionCost);
 	m_energy -= ActionCost;
 }
 
+int Energy::getTicksToTurn() const
+{
+	if (canTakeTurn())
+		return 0;
+
+	const int gain = Gains[m_speed + Normal];
+
+	return (ActionCost - m_energy + gain - 1) / gain;
+}
+
 int Energy::ticksPerTurn()
 {
 	return Gains[Max] / Gains[Normal];
@@ -94,4 +111,9 @@ void Energy::setAction(Action::Ptr action)
 	m_action = std::move(action);
 }
 
+std::weak_ptr<const void> Energy::getLifetime() const
+{
+	return m_lifetime.token;
+}
+
 }
@@ -3,10 +3,12 @@
 
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Window/Event.hpp>
+#include <SFML/System/Sleep.hpp>
 
 #include <sstream>
 #include <filesystem>
 #include <iomanip>
+#include <stdexcept>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -21,10 +23,14 @@ void Application::run()
 {
 	const sf::Time timePerFrame = sf::seconds(1.f / 60.f);
 
+	// NOTE: also checked in release, a game still using the window before create would do nothing
+	if (!m_window || !m_window->isOpen())
+		throw std::runtime_error("Failed to run the application, the window was not created.");
+
 	sf::Clock clock;
 	sf::Time timeSinceLastUpdate;
 
-	while (m_window.isOpen())
+	while (m_window->isOpen())
 	{
 		const sf::Time dt = clock.restart();
 		timeSinceLastUpdate += dt;
@@ -35,9 +41,10 @@ void Application::run()
 
 			processInput();
 			update(timePerFrame);
+			++m_frame;
 
 			if (m_stateStack.isEmpty())
-				m_window.close();
+				m_window->close();
 		}
 
 		if (m_displayFps)
@@ -47,11 +54,117 @@ void Application::run()
 	}
 }
 
+Application::HeadlessReport Application::runHeadless(std::size_t frameCount, const Input& input, sf::Time timePerFrame,
+	bool fixedRate, const std::function<std::size_t()>& turnCount)
+{
+	HeadlessReport report;
+
+	const std::size_t firstTurn = turnCount ? turnCount() : 0;
+	std::vector<sf::Event> events;
+
+	sf::Clock totalClock;
+	sf::Clock clock;
+
+	for (std::size_t i = 0; i < frameCount; ++i)
+	{
+		const sf::Time frameStart = totalClock.getElapsedTime();
+
+		clock.restart();
+
+		events.clear();
+
+		if (input)
+			input(i, events);
+
+		for (const auto& event : events)
+			m_stateStack.handleEvent(event);
+
+		report.input += clock.restart();
+
+		update(timePerFrame);
+
+		report.update += clock.restart();
+		++report.frames;
+
+		if (m_stateStack.isEmpty())
+			break;
+
+		if (fixedRate)
+			sf::sleep(timePerFrame - (totalClock.getElapsedTime() - frameStart));
+	}
+
+	report.total = totalClock.getElapsedTime();
+	report.turns = turnCount ? turnCount() - firstTurn : 0;
+
+	return report;
+}
+
+void Application::setRecording(bool enabled)
+{
+	m_recording = enabled;
+
+	// NOTE: the frames are counted from the start of the recording, the first replayed frame is 0
+	if (m_recording)
+	{
+		m_recordedEvents.clear();
+		m_frame = 0;
+	}
+}
+
+const std::vector<Application::InputEvent>& Application::getRecording() const
+{
+	return m_recordedEvents;
+}
+
+Application::Input Application::replay(std::vector<InputEvent> events)
+{
+	// NOTE: the events are sorted by frame
+	return [events = std::move(events), next = std::size_t(0)] (std::size_t frame, std::vector<sf::Event>& output) mutable
+	{
+		for (; next < events.size() && events[next].frame <= frame; ++next)
+			output.push_back(events[next].event);
+	};
+}
+
+float Application::HeadlessReport::getTurnsPerSecond() const
+{
+	if (total == sf::Time::Zero)
+		return 0.f;
+
+	return turns / total.asSeconds();
+}
+
+void Application::HeadlessReport::print(std::ostream& stream) const
+{
+	const auto count = static_cast<sf::Int64>(std::max<std::size_t>(frames, 1));
+
+	stream << "frames: " << frames
+		<< ", turns: " << turns
+		<< ", turns/s: " << static_cast<long long>(getTurnsPerSecond())
+		<< ", input: " << input.asMicroseconds() / count << " us"
+		<< ", update: " << update.asMicroseconds() / count << " us"
+		<< ", total: " << total.asMilliseconds() << " ms" << '\n';
+}
+
 Application::Application()
 {
 	Action::setStateStack(m_stateStack);
 }
 
+void Application::create(sf::VideoMode mode, const sf::String& title, sf::Uint32 style, const sf::ContextSettings& settings)
+{
+	m_window = std::make_unique<sf::RenderWindow>(mode, title, style, settings);
+}
+
+sf::RenderWindow& Application::getWindow()
+{
+	// NOTE: not opened, getWindow().create(...) works as m_window.create(...) did
+	if (!m_window)
+		m_window = std::make_unique<sf::RenderWindow>();
+
+	return *m_window;
+}
+
 void Application::initializeFpsText(const sf::Font& font, int fontSize)
 {
 	m_fpsText.setFont(font);
@@ -86,8 +199,8 @@ void Application::initializeDebugGrid(const sf::Vector2i& gridSize)
 		return texture;
 	}();
 
-	const int width = m_window.getSize().x;
-	const int height = m_window.getSize().y;
+	const int width = m_window->getSize().x;
+	const int height = m_window->getSize().y;
 
 	m_gridSprite.setTexture(texture);
 	m_gridSprite.setTextureRect({ 0, 0, width, height });
@@ -119,8 +232,8 @@ void Application::initializeFilter()
 		return texture;
 	}();
 
-	const int width = m_window.getSize().x;
-	const int height = m_window.getSize().y;
+	const int width = m_window->getSize().x;
+	const int height = m_window->getSize().y;
 
 	m_filterSprite.setTexture(texture);
 	m_filterSprite.setTextureRect({ 0, 0, width, height });
@@ -131,10 +244,10 @@ void Application::processInput()
 {
 	sf::Event event;
 
-	while (m_window.pollEvent(event))
+	while (m_window->pollEvent(event))
 	{
 		if (event.type == sf::Event::Closed)
-			m_window.close();
+			m_window->close();
 
 		else if (event.type == sf::Event::KeyPressed)
 		{
@@ -166,6 +279,9 @@ void Application::processInput()
 				continue;
 		}
 
+		if (m_recording)
+			m_recordedEvents.push_back({ m_frame, event });
+
 		m_stateStack.handleEvent(event);
 	}
 
@@ -182,23 +298,23 @@ void Application::update(sf::Time dt)
 
 void Application::render()
 {
-	m_window.clear(m_clearColor);
-	m_window.draw(m_stateStack);
+	m_window->clear(m_clearColor);
+	m_window->draw(m_stateStack);
 
 	if (m_displayFilter)
-		m_window.draw(m_filterSprite);
+		m_window->draw(m_filterSprite);
 	if (m_displayGrid)
 		drawGrid();
 	if (m_displayFps)
-		m_window.draw(m_fpsText);
+		m_window->draw(m_fpsText);
 
-	m_window.display();
+	m_window->display();
 }
 
 void Application::centerWindow()
 {
 #ifdef _WIN32
-	HWND hWnd = m_window.getSystemHandle();
+	HWND hWnd = m_window->getSystemHandle();
 
 	RECT rect;
 	GetClientRect(hWnd, &rect);
@@ -231,11 +347,11 @@ void Application::centerWindow()
 
 void Application::takeScreenshot()
 {
-	const sf::Vector2u windowSize = m_window.getSize();
+	const sf::Vector2u windowSize = m_window->getSize();
 
 	sf::Texture texture;
 	texture.create(windowSize.x, windowSize.y);
-	texture.update(m_window);
+	texture.update(*m_window);
 
 	const sf::Image screenshot = texture.copyToImage();
 
@@ -272,14 +388,14 @@ void Application::countFrame(sf::Time dt)
 
 void Application::drawGrid()
 {
-	m_window.draw(m_gridSprite);
+	m_window->draw(m_gridSprite);
 
 	// HACK: real-time mouse input
 
 	static bool mousePressed = false;
 	static sf::Vector2i mousePressedPos;
 
-	sf::Vector2i mousePos = sf::Mouse::getPosition(m_window);
+	sf::Vector2i mousePos = sf::Mouse::getPosition(*m_window);
 	mousePos.x /= m_gridSize.x;
 	mousePos.y /= m_gridSize.y;
 
@@ -325,12 +441,12 @@ void Application::drawGrid()
 	const sf::FloatRect bounds = mouseText.getLocalBounds();
 	mouseText.setOrigin(0.f, bounds.top + bounds.height);
 
-	const float x = std::clamp((mousePos.x + 1) * rectSize.x, 0.f, m_window.getView().getSize().x - (bounds.left + bounds.width));
-	const float y = std::clamp(mousePos.y * rectSize.y, bounds.height, m_window.getView().getSize().y);
+	const float x = std::clamp((mousePos.x + 1) * rectSize.x, 0.f, m_window->getView().getSize().x - (bounds.left + bounds.width));
+	const float y = std::clamp(mousePos.y * rectSize.y, bounds.height, m_window->getView().getSize().y);
 	mouseText.setPosition(x, y);
 
-	m_window.draw(mouseRect);
-	m_window.draw(mouseText);
+	m_window->draw(mouseRect);
+	m_window->draw(mouseText);
 
 	if (mouseText.getGlobalBounds().intersects(m_fpsText.getGlobalBounds()))
 		m_fpsText.setString("");
@@ -1,13 +1,145 @@
 #include "Console.hpp"
+#include "SoftwareTarget.hpp"
 
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 
 #include <iostream>
+#include <cassert>
+
+namespace
+{
+	// box-drawing characters (U+2500 to U+257F): left, up, right and down lines
+	// . none, l light, h heavy, d double
+	// NOTE: dashed lines are solid, arcs are corners and diagonals (U+2571 to U+2573) come from the font
+	const char* const BoxLines[128] =
+	{
+		"l.l.", "h.h.", ".l.l", ".h.h", "l.l.", "h.h.", ".l.l", ".h.h", "l.l.", "h.h.", ".l.l", ".h.h", "..ll", "..hl", "..lh", "..hh",
+		"l..l", "h..l", "l..h", "h..h", ".ll.", ".lh.", ".hl.", ".hh.", "ll..", "hl..", "lh..", "hh..", ".lll", ".lhl", ".hll", ".llh",
+		".hlh", ".hhl", ".lhh", ".hhh", "ll.l", "hl.l", "lh.l", "ll.h", "lh.h", "hh.l", "hl.h", "hh.h", "l.ll", "h.ll", "l.hl", "h.hl",
+		"l.lh", "h.lh", "l.hh", "h.hh", "lll.", "hll.", "llh.", "hlh.", "lhl.", "hhl.", "lhh.", "hhh.", "llll", "hlll", "llhl", "hlhl",
+		"lhll", "lllh", "lhlh", "hhll", "lhhl", "hllh", "llhh", "hhhl", "hlhh", "hhlh", "lhhh", "hhhh", "l.l.", "h.h.", ".l.l", ".h.h",
+		"d.d.", ".d.d", "..dl", "..ld", "..dd", "d..l", "l..d", "d..d", ".ld.", ".dl.", ".dd.", "dl..", "ld..", "dd..", ".ldl", ".dld",
+		".ddd", "dl.l", "ld.d", "dd.d", "d.dl", "l.ld", "d.dd", "dld.", "ldl.", "ddd.", "dldl", "ldld", "dddd", "..ll", "l..l", "ll..",
+		".ll.", "....", "....", "....", "l...", ".l..", "..l.", "...l", "h...", ".h..", "..h.", "...h", "l.h.", ".l.h", "h.l.", ".h.l",
+	};
+
+	// block elements (U+2580 to U+259F): left, top, width and height in eighths, and alpha (shades)
+	struct Block
+	{
+		int left, top, width, height;
+		sf::Uint8 alpha;
+	};
+
+	// quadrants (U+2596 to U+259F): upper left 1, upper right 2, lower left 4, lower right 8
+	const int Quadrants[10] = { 4, 8, 1, 1 | 4 | 8, 1 | 8, 1 | 2 | 4, 1 | 2 | 8, 2, 2 | 4, 2 | 4 | 8 };
+
+	Block getBlock(int index)
+	{
+		if (index == 0x00)
+			return { 0, 0, 8, 4, 255 };
+		if (index <= 0x07)
+			return { 0, 8 - index, 8, index, 255 };
+		if (index == 0x08)
+			return { 0, 0, 8, 8, 255 };
+		if (index <= 0x0f)
+			return { 0, 0, 16 - index, 8, 255 };
+		if (index == 0x10)
+			return { 4, 0, 4, 8, 255 };
+		if (index <= 0x13)
+			return { 0, 0, 8, 8, static_cast<sf::Uint8>((index - 0x10) * 64) };
+		if (index == 0x14)
+			return { 0, 0, 8, 1, 255 };
+
+		return { 7, 0, 1, 8, 255 }; // 0x15
+	}
+
+	const wchar_t BoxFirst = 0x2500;
+	const wchar_t BoxLast = 0x259f;
+
+	bool isBox(wchar_t ch)
+	{
+		return ch >= BoxFirst && ch <= BoxLast && !(ch >= 0x2571 && ch <= 0x2573);
+	}
+
+	// [begin, end) of a line of the thickness centered on center
+	std::pair<int, int> getBand(int center, int thickness)
+	{
+		return { center - thickness / 2, center - thickness / 2 + thickness };
+	}
+
+	bool isBoxPixel(int index, int x, int y, int width, int height)
+	{
+		const char* lines = BoxLines[index]; // left, up, right, down
+		const int t = std::max(1, width / 8);
+
+		const auto getThickness = [t] (char line)
+		{
+			switch (line)
+			{
+			case 'l': return t;
+			case 'h': return t * 2;
+			case 'd': return t * 3;
+			default:  return 0;
+			}
+		};
+
+		bool solid = false; // double lines with the gap between them
+		bool gap = false;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			if (lines[i] == '.')
+				continue;
+
+			const bool horizontal = (i % 2 == 0);
+			const int along = horizontal ? x : y;
+			const int across = horizontal ? y : x;
+			const int middle = horizontal ? width / 2 : height / 2;
+			const int crossMiddle = horizontal ? height / 2 : width / 2;
+			const int size = horizontal ? width : height;
+
+			// lines reach over the middle to the far side of the widest crossing line
+			const int crossing = horizontal ? std::max(getThickness(lines[1]), getThickness(lines[3])) : std::max(getThickness(lines[0]), getThickness(lines[2]));
+			const auto reach = getBand(middle, crossing);
+
+			const bool inLine = (i < 2) ? (along < reach.second) : (along >= reach.first && along < size);
+			const auto band = getBand(crossMiddle, getThickness(lines[i]));
+
+			if (!inLine || across < band.first || across >= band.second)
+				continue;
+
+			if (lines[i] != 'd')
+				return true;
+
+			solid = true;
+
+			const auto inner = getBand(crossMiddle, t);
+			const auto innerReach = getBand(middle, t);
+			const bool inGap = (i < 2) ? (along < innerReach.second) : (along >= innerReach.first);
+
+			if (inGap && across >= inner.first && across < inner.second)
+				gap = true;
+		}
+
+		return solid && !gap;
+	}
+}
 
 namespace rl
 {
 
+bool Console::Cell::operator==(const Cell& cell) const
+{
+	return ch == cell.ch && colors == cell.colors;
+}
+
+bool Console::Cell::operator!=(const Cell& cell) const
+{
+	return !(*this == cell);
+}
+
 Console::Console(const sf::Vector2i& size, const sf::Font& font, int fontSize)
 {
 	create(size, font, fontSize);
@@ -32,9 +164,12 @@ void Console::create(const sf::Vector2i& size, const sf::Font& font, int fontSiz
 	m_offset.y = -std::floor((topSpace - bottomSpace) / 2);
 	std::cout << "Console Character Offset: " << m_offset.x << ", " << m_offset.y << '\n';
 
+	m_cells.assign(m_size.x * m_size.y, Cell());
+	m_drawnCells = m_cells;
+
 	for (auto& layer : m_layers)
 	{
-		layer.resize(m_size.x * m_size.y * 4);
+		layer.assign(m_size.x * m_size.y * 4, sf::Vertex());
 
 		for (int y = 0; y < m_size.y; ++y)
 			for (int x = 0; x < m_size.x; ++x)
@@ -48,11 +183,31 @@ void Console::create(const sf::Vector2i& size, const sf::Font& font, int fontSiz
 			}
 	}
 
-	// preload ascii glyphs from ' ' to '~'
-	for (std::size_t i = 0; i < m_ascii.size(); ++i)
-		m_ascii[i] = &m_font->getGlyph(i + 32, m_fontSize, false);
+	m_glyphs.clear();
+
+	for (auto& range : m_glyphRanges)
+		loadGlyphs(range);
+
+	createBoxTexture();
+
+	m_verticesNeedUpdate = true;
+}
+
+void Console::create(const sf::Vector2i& size)
+{
+	m_size = size;
+	m_font = nullptr;
+	m_texture = nullptr;
+	m_cells.assign(m_size.x * m_size.y, Cell());
+	m_drawnCells = m_cells;
+}
+
+void Console::preloadGlyphs(wchar_t first, wchar_t last)
+{
+	m_glyphRanges.push_back({ first, last, {} });
 
-	// TODO: create box-drawing characters here
+	if (m_font)
+		loadGlyphs(m_glyphRanges.back());
 }
 
 void Console::clear()
@@ -63,10 +218,15 @@ void Console::clear()
 
 void Console::clear(Layer layer)
 {
-	if (layer != TextLayer)
-		std::for_each(m_layers[layer].begin(), m_layers[layer].end(), [] (auto& v) { v.color = sf::Color::Transparent; });
-	else
-		std::fill(m_layers[layer].begin(), m_layers[layer].end(), sf::Vertex());
+	for (auto& cell : m_cells)
+	{
+		cell.colors[layer] = sf::Color::Transparent;
+
+		if (layer == TextLayer)
+			cell.ch = 0;
+	}
+
+	m_verticesNeedUpdate = true;
 }
 
 void Console::setChar(int x, int y, wchar_t ch, const sf::Color& color)
@@ -74,29 +234,12 @@ void Console::setChar(int x, int y, wchar_t ch, const sf::Color& color)
 	if (!isInBounds(x, y))
 		return;
 
-	const sf::Glyph* glyph = nullptr;
+	Cell& cell = m_cells[x + y * m_size.x];
 
-	if (ch >= 32 && ch < 127)
-		glyph = m_ascii[ch - 32];
-	else
-		glyph = &m_font->getGlyph(ch, m_fontSize, false);
+	cell.ch = ch;
+	cell.colors[TextLayer] = color;
 
-	const float x1 = glyph->bounds.left + m_offset.x;
-	const float y1 = glyph->bounds.top + m_fontSize + m_offset.y;
-	const float x2 = glyph->bounds.left + glyph->bounds.width + m_offset.x;
-	const float y2 = glyph->bounds.top + glyph->bounds.height + m_fontSize + m_offset.y;
-
-	const float u1 = static_cast<float>(glyph->textureRect.left);
-	const float v1 = static_cast<float>(glyph->textureRect.top);
-	const float u2 = static_cast<float>(glyph->textureRect.left + glyph->textureRect.width);
-	const float v2 = static_cast<float>(glyph->textureRect.top + glyph->textureRect.height);
-
-	sf::Vertex* quad = &m_layers[TextLayer][(x + y * m_size.x) * 4];
-
-	quad[0] = { { x * m_tileSize.x + x1, y * m_tileSize.y + y1 }, color, { u1, v1 } };
-	quad[1] = { { x * m_tileSize.x + x2, y * m_tileSize.y + y1 }, color, { u2, v1 } };
-	quad[2] = { { x * m_tileSize.x + x2, y * m_tileSize.y + y2 }, color, { u2, v2 } };
-	quad[3] = { { x * m_tileSize.x + x1, y * m_tileSize.y + y2 }, color, { u1, v2 } };
+	m_verticesNeedUpdate = true;
 }
 
 void Console::setString(int x, int y, const std::wstring& string, const sf::Color& color)
@@ -128,12 +271,8 @@ void Console::setColor(int x, int y, const sf::Color& color, Layer layer)
 	if (!isInBounds(x, y))
 		return;
 
-	sf::Vertex* quad = &m_layers[layer][(x + y * m_size.x) * 4];
-
-	quad[0].color = color;
-	quad[1].color = color;
-	quad[2].color = color;
-	quad[3].color = color;
+	m_cells[x + y * m_size.x].colors[layer] = color;
+	m_verticesNeedUpdate = true;
 }
 
 void Console::setColor(int left, int top, int width, int height, const sf::Color& color, Layer layer)
@@ -148,12 +287,8 @@ void Console::setColorA(int x, int y, const sf::Uint8 alpha, Layer layer)
 	if (!isInBounds(x, y))
 		return;
 
-	sf::Vertex* quad = &m_layers[layer][(x + y * m_size.x) * 4];
-
-	quad[0].color.a = alpha;
-	quad[1].color.a = alpha;
-	quad[2].color.a = alpha;
-	quad[3].color.a = alpha;
+	m_cells[x + y * m_size.x].colors[layer].a = alpha;
+	m_verticesNeedUpdate = true;
 }
 
 void Console::setColorA(const sf::IntRect& rect, const sf::Uint8 alpha, Layer layer)
@@ -166,6 +301,12 @@ void Console::setColorA(const sf::IntRect& rect, const sf::Uint8 alpha, Layer la
 void Console::setOffsetX(float offsetX)
 {
 	m_offset.x = offsetX;
+
+	// rebuild the characters with the new offset
+	for (auto& cell : m_drawnCells)
+		cell.ch = static_cast<wchar_t>(-1);
+
+	m_verticesNeedUpdate = true;
 }
 
 const sf::Vector2i& Console::getSize() const
@@ -178,14 +319,254 @@ const sf::Vector2f& Console::getTileSize() const
 	return m_tileSize;
 }
 
+wchar_t Console::getChar(int x, int y) const
+{
+	assert(isInBounds(x, y));
+
+	return m_cells[x + y * m_size.x].ch;
+}
+
+const sf::Color& Console::getColor(int x, int y, Layer layer) const
+{
+	assert(isInBounds(x, y));
+
+	return m_cells[x + y * m_size.x].colors[layer];
+}
+
+bool Console::isEmpty(const Cell& cell, int layer) const
+{
+	if (layer == TextLayer && (cell.ch == 0 || cell.ch == L' ' || isBox(cell.ch)))
+		return true;
+
+	if (layer == BoxLayer)
+		return !isBox(cell.ch) || cell.colors[TextLayer].a == 0;
+
+	return cell.colors[layer].a == 0;
+}
+
+void Console::loadGlyphs(GlyphRange& range)
+{
+	range.glyphs.resize(range.last - range.first + 1);
+
+	for (wchar_t ch = range.first; ch <= range.last; ++ch)
+		range.glyphs[ch - range.first] = &m_font->getGlyph(ch, m_fontSize, false);
+}
+
+const sf::Glyph& Console::getGlyph(wchar_t ch) const
+{
+	for (const auto& range : m_glyphRanges)
+	{
+		if (ch >= range.first && ch <= range.last)
+			return *range.glyphs[ch - range.first];
+	}
+
+	const sf::Glyph*& glyph = m_glyphs[ch];
+
+	if (!glyph)
+		glyph = &m_font->getGlyph(ch, m_fontSize, false);
+
+	return *glyph;
+}
+
+void Console::createBoxTexture()
+{
+	// NOTE: one white glyph per cell size, so the lines join across the cells
+	const int width = static_cast<int>(std::round(m_tileSize.x));
+	const int height = static_cast<int>(std::round(m_tileSize.y));
+
+	sf::Image image;
+	image.create(width * 16, height * 10, sf::Color::Transparent);
+
+	for (int index = 0; index <= BoxLast - BoxFirst; ++index)
+	{
+		const int left = (index % 16) * width;
+		const int top = (index / 16) * height;
+
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+			{
+				sf::Uint8 alpha = 0;
+
+				if (index < 0x80)
+					alpha = isBoxPixel(index, x, y, width, height) ? 255 : 0;
+
+				else if (index < 0x96)
+				{
+					const Block block = getBlock(index - 0x80);
+
+					if (x >= width * block.left / 8 && x < width * (block.left + block.width) / 8 &&
+						y >= height * block.top / 8 && y < height * (block.top + block.height) / 8)
+						alpha = block.alpha;
+				}
+
+				else
+				{
+					const int quadrant = (x < width / 2 ? 1 : 2) * (y < height / 2 ? 1 : 4);
+
+					if (Quadrants[index - 0x96] & quadrant)
+						alpha = 255;
+				}
+
+				if (alpha > 0)
+					image.setPixel(left + x, top + y, sf::Color(255, 255, 255, alpha));
+			}
+	}
+
+	m_boxTexture.loadFromImage(image);
+}
+
+void Console::updateCell(int index) const
+{
+	const Cell& cell = m_cells[index];
+
+	for (int i = 0; i < LayerCount; ++i)
+	{
+		if (i == TextLayer)
+			continue;
+
+		sf::Vertex* quad = &m_layers[i][index * 4];
+
+		quad[0].color = cell.colors[i];
+		quad[1].color = cell.colors[i];
+		quad[2].color = cell.colors[i];
+		quad[3].color = cell.colors[i];
+	}
+
+	sf::Vertex* quad = &m_layers[TextLayer][index * 4];
+	sf::Vertex* box = &m_layers[BoxLayer][index * 4];
+
+	const sf::Color& color = cell.colors[TextLayer];
+
+	if (isBox(cell.ch))
+	{
+		std::fill(quad, quad + 4, sf::Vertex());
+
+		const float width = std::round(m_tileSize.x);
+		const float height = std::round(m_tileSize.y);
+		const float u = ((cell.ch - BoxFirst) % 16) * width;
+		const float v = ((cell.ch - BoxFirst) / 16) * height;
+
+		box[0].texCoords = { u, v };
+		box[1].texCoords = { u + width, v };
+		box[2].texCoords = { u + width, v + height };
+		box[3].texCoords = { u, v + height };
+
+		for (int k = 0; k < 4; ++k)
+			box[k].color = color;
+
+		return;
+	}
+
+	for (int k = 0; k < 4; ++k)
+		box[k].color = sf::Color::Transparent;
+
+	if (cell.ch == 0)
+	{
+		std::fill(quad, quad + 4, sf::Vertex());
+		return;
+	}
+
+	const sf::Glyph* glyph = &getGlyph(cell.ch);
+
+	const int x = index % m_size.x;
+	const int y = index / m_size.x;
+
+	const float x1 = glyph->bounds.left + m_offset.x;
+	const float y1 = glyph->bounds.top + m_fontSize + m_offset.y;
+	const float x2 = glyph->bounds.left + glyph->bounds.width + m_offset.x;
+	const float y2 = glyph->bounds.top + glyph->bounds.height + m_fontSize + m_offset.y;
+
+	const float u1 = static_cast<float>(glyph->textureRect.left);
+	const float v1 = static_cast<float>(glyph->textureRect.top);
+	const float u2 = static_cast<float>(glyph->textureRect.left + glyph->textureRect.width);
+	const float v2 = static_cast<float>(glyph->textureRect.top + glyph->textureRect.height);
+
+	quad[0] = { { x * m_tileSize.x + x1, y * m_tileSize.y + y1 }, color, { u1, v1 } };
+	quad[1] = { { x * m_tileSize.x + x2, y * m_tileSize.y + y1 }, color, { u2, v1 } };
+	quad[2] = { { x * m_tileSize.x + x2, y * m_tileSize.y + y2 }, color, { u2, v2 } };
+	quad[3] = { { x * m_tileSize.x + x1, y * m_tileSize.y + y2 }, color, { u1, v2 } };
+}
+
+void Console::updateVertices() const
+{
+	// frame diff: the cells are usually cleared and written again every frame
+	bool changed = false;
+
+	for (std::size_t i = 0; i < m_cells.size(); ++i)
+	{
+		if (m_cells[i] != m_drawnCells[i])
+		{
+			updateCell(static_cast<int>(i));
+			m_drawnCells[i] = m_cells[i];
+			changed = true;
+		}
+	}
+
+	if (changed)
+		updateRuns();
+
+	m_verticesNeedUpdate = false;
+}
+
+void Console::updateRuns() const
+{
+	// NOTE: a gap shorter than a row is drawn with the run, so empty rows split the runs
+	for (int i = 0; i < VertexLayerCount; ++i)
+	{
+		auto& runs = m_runs[i];
+		runs.clear();
+
+		int last = -1;
+
+		for (int index = 0; index < static_cast<int>(m_cells.size()); ++index)
+		{
+			if (isEmpty(m_cells[index], i))
+				continue;
+
+			if (last < 0 || index - last > m_size.x)
+				runs.push_back({ index, 1 });
+			else
+				runs.back().count = index - runs.back().first + 1;
+
+			last = index;
+		}
+	}
+}
+
+void Console::draw(SoftwareTarget& target, sf::RenderStates states) const
+{
+	render(target, states);
+}
+
 void Console::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	render(target, states);
+}
+
+template <typename Target>
+void Console::render(Target& target, sf::RenderStates states) const
+{
+	if (!m_font)
+		return;
+
+	if (m_verticesNeedUpdate)
+		updateVertices();
+
 	states.transform *= getTransform();
 
-	for (int i = 0; i < LayerCount; ++i)
+	const int layers[] = { Background, TextLayer, BoxLayer, Foreground };
+
+	for (const int i : layers)
 	{
-		states.texture = (i == TextLayer ? m_texture : nullptr);
-		target.draw(&m_layers[i][0], m_layers[i].size(), sf::Quads, states);
+		if (i == TextLayer)
+			states.texture = m_texture;
+		else if (i == BoxLayer)
+			states.texture = &m_boxTexture;
+		else
+			states.texture = nullptr;
+
+		for (const auto& run : m_runs[i])
+			target.draw(&m_layers[i][run.first * 4], run.count * 4, sf::Quads, states);
 	}
 }
 
@@ -1,4 +1,5 @@
 #include "GUI/Button.hpp"
+#include "GUI/QuadBatch.hpp"
 #include "Utility.hpp"
 // #include "Console.hpp"
 
@@ -48,6 +49,8 @@ void Button::setSize(const sf::Vector2i& size)
 
 	m_button.setSize({ width, height });
 	setTextAlignment(m_alignment);
+
+	markDirty();
 }
 
 void Button::setText(const sf::String& string)
@@ -72,6 +75,8 @@ void Button::setText(const sf::String& string)
 void Button::setTextColor(const sf::Color& color)
 {
 	m_text.setFillColor(color);
+
+	markDirty();
 }
 
 void Button::setTextAlignment(Alignment align)
@@ -96,6 +101,8 @@ void Button::setTextAlignment(Alignment align)
 		setAnchorA(m_text, { 1.f, 0.5f });
 		m_text.setPosition((m_size.x - 1.f) * TileSize.x, std::floor(m_button.getSize().y / 2));
 	}
+
+	markDirty();
 }
 
 void Button::setCallback(Callback callback)
@@ -142,7 +149,32 @@ void Button::update(sf::Time dt)
 		sf::Color color = m_button.getFillColor();
 		color.a = std::max(0, color.a - dt.asMilliseconds()); // 16
 		m_button.setFillColor(color);
+
+		markDirty();
+	}
+}
+
+void Button::appendQuads(QuadBatch& batch, const sf::Transform& transform) const
+{
+	const sf::Transform combined = transform * getTransform();
+	const sf::Color& color = m_button.getFillColor();
+
+	if (color.a > 0)
+	{
+		const sf::Vector2f& size = m_button.getSize();
+
+		const sf::Vertex quad[] =
+		{
+			sf::Vertex(sf::Vector2f(0.f, 0.f), color),
+			sf::Vertex(sf::Vector2f(size.x, 0.f), color),
+			sf::Vertex(sf::Vector2f(size.x, size.y), color),
+			sf::Vertex(sf::Vector2f(0.f, size.y), color),
+		};
+
+		batch.append(nullptr, quad, 4, combined * m_button.getTransform());
 	}
+
+	batch.append(m_text, combined);
 }
 
 void Button::setButtonColors(const sf::Color& selectedColor, const sf::Color& pressedColor)
@@ -167,6 +199,8 @@ void Button::changeButton(Type buttonType)
 		m_button.setFillColor(s_pressedColor);
 		break;
 	}
+
+	markDirty();
 }
 
 void Button::onSelect()
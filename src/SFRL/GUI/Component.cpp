@@ -1,4 +1,5 @@
 #include "GUI/Component.hpp"
+#include "GUI/QuadBatch.hpp"
 
 namespace rl
 {
@@ -23,6 +24,8 @@ void Component::setPosition(int x, int y)
 	const float fy = static_cast<float>(y * s_tileSize.y);
 
 	sf::Transformable::setPosition(fx, fy);
+
+	markDirty();
 }
 
 void Component::setPosition(const sf::Vector2i& position)
@@ -53,6 +56,7 @@ bool Component::isSelected() const
 void Component::select()
 {
 	m_selected = true;
+	markDirty();
 
 	onSelect();
 }
@@ -60,6 +64,7 @@ void Component::select()
 void Component::deselect()
 {
 	m_selected = false;
+	markDirty();
 
 	onDeselect();
 }
@@ -72,6 +77,7 @@ bool Component::isActive() const
 void Component::activate()
 {
 	m_active = true;
+	markDirty();
 
 	onActivate();
 }
@@ -79,6 +85,7 @@ void Component::activate()
 void Component::deactivate()
 {
 	m_active = false;
+	markDirty();
 
 	onDeactivate();
 }
@@ -96,6 +103,22 @@ void Component::update(sf::Time dt)
 {
 }
 
+void Component::appendQuads(QuadBatch& batch, const sf::Transform& transform) const
+{
+	batch.append(*this, transform);
+}
+
+bool Component::isDirty() const
+{
+	return m_dirty;
+}
+
+void Component::markDirty()
+{
+	for (Component* component = this; component; component = component->m_parent)
+		component->m_dirty = true;
+}
+
 void Component::setTileSize(const sf::Vector2i& tileSize)
 {
 	s_tileSize = tileSize;
@@ -46,11 +46,15 @@ void Container::clear()
 {
 	m_selectedChild = -1;
 	m_children.clear();
+
+	markDirty();
 }
 
 void Container::pack(Component::Ptr component)
 {
+	component->m_parent = this;
 	m_children.emplace_back(std::move(component));
+	markDirty();
 
 	if (!hasSelection() && m_children.back()->isSelectable())
 		select(m_children.size() - 1);
@@ -174,6 +178,15 @@ void Container::selectNext()
 	select(next);
 }
 
+void Container::appendChildren(QuadBatch& batch, const sf::Transform& transform) const
+{
+	for (const auto& child : m_children)
+	{
+		child->appendQuads(batch, transform);
+		child->m_dirty = false;
+	}
+}
+
 void Container::onActivate()
 {
 	if (hasSelection())
@@ -186,12 +199,22 @@ void Container::onDeactivate()
 		m_children[m_selectedChild]->deselect();
 }
 
+void Container::appendQuads(QuadBatch& batch, const sf::Transform& transform) const
+{
+	appendChildren(batch, transform * getTransform());
+}
+
 void Container::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-	states.transform *= getTransform();
+	if (isDirty())
+	{
+		m_batch.clear();
+		appendChildren(m_batch, sf::Transform::Identity);
+		m_dirty = false;
+	}
 
-	for (const auto& child : m_children)
-		target.draw(*child, states);
+	states.transform *= getTransform();
+	target.draw(m_batch, states);
 }
 
 }
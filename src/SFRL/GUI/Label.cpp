@@ -1,8 +1,11 @@
 #include "GUI/Label.hpp"
+#include "GUI/QuadBatch.hpp"
 #include "Utility.hpp"
 // #include "Console.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Font.hpp>
 
 namespace rl
 {
@@ -34,22 +37,29 @@ const sf::Vector2i& Label::getSize() const
 
 void Label::setSize(const sf::Vector2i& size)
 {
+	if (size.x != m_size.x)
+		m_linesNeedUpdate = true;
+
 	m_size = size;
-	m_textsNeedUpdate = true;
+	m_verticesNeedUpdate = true;
+
+	markDirty();
 }
 
 std::size_t Label::getNumLines() const
 {
-	if (m_textsNeedUpdate)
-		updateTexts();
+	if (m_linesNeedUpdate)
+		updateLines();
 
-	return m_texts.size();
+	return m_lines.size();
 }
 
 void Label::setText(const sf::String& string)
 {
 	m_string = string;
-	m_textsNeedUpdate = true;
+	m_linesNeedUpdate = true;
+
+	markDirty();
 
 	// auto resize
 	if (m_size == sf::Vector2i(0, 0))
@@ -64,55 +74,84 @@ void Label::setText(const sf::String& string)
 void Label::setTextColor(const sf::Color& color)
 {
 	m_color = color;
-	m_textsNeedUpdate = true;
+	m_verticesNeedUpdate = true;
+
+	markDirty();
 }
 
 void Label::setTextWrap(bool flag)
 {
 	m_wrap = flag;
-	m_textsNeedUpdate = true;
+	m_linesNeedUpdate = true;
+
+	markDirty();
 }
 
 void Label::setTextAlignment(Alignment align)
 {
 	m_alignment = align;
-	m_textsNeedUpdate = true;
+	m_verticesNeedUpdate = true;
+
+	markDirty();
 }
 
-void Label::updateTexts() const
+void Label::appendQuads(QuadBatch& batch, const sf::Transform& transform) const
 {
-	m_texts.clear();
+	if (m_linesNeedUpdate)
+		updateLines();
 
-	const float width = static_cast<float>(m_size.x * TileSize.x);
-	const float height = static_cast<float>(m_size.y * TileSize.y);
+	if (m_verticesNeedUpdate)
+		updateVertices();
 
-	if (!m_wrap)
+	batch.append(&m_font->getTexture(m_fontSize), m_vertices.data(), m_vertices.size(), transform * getTransform());
+}
+
+void Label::updateLines() const
+{
+	const std::size_t size = m_string.getSize();
+
+	// glyphs and kerning are looked up once per character, for the line breaks and the vertices
+	m_characters.clear();
+	m_characters.reserve(size);
+
+	sf::Uint32 prevChar = 0;
+
+	for (std::size_t i = 0; i < size; ++i)
 	{
-		m_texts.emplace_back(m_string, *m_font, m_fontSize);
-		m_texts.back().setPosition(std::floor(width / 2), std::floor(height / 2));
+		const sf::Uint32 curChar = m_string[i];
+		const bool whitespace = (curChar == L' ' || curChar == L'\t' || curChar == L'\n');
+
+		m_characters.push_back({ whitespace ? nullptr : &m_font->getGlyph(curChar, m_fontSize, false), m_font->getKerning(prevChar, curChar, m_fontSize) });
+		prevChar = curChar;
 	}
 
+	m_lines.clear();
+
+	if (!m_wrap)
+		m_lines.push_back({ 0, size });
+
 	else
 	{
 		// TODO: scrollbar
 
+		const float width = static_cast<float>(m_size.x * TileSize.x);
 		const float whitespaceWidth = m_font->getGlyph(L' ', m_fontSize, false).advance;
 
-		std::wstring curStr = m_string;
+		// NOTE: only the last word of a line is measured again, on the next line
+		std::size_t first = 0;
 
-		while (!curStr.empty())
+		while (first < size)
 		{
 			float x = 0.f;
-			wchar_t prevChar = 0;
-			std::size_t i = 0;
-			std::size_t lastSpace = 0;
+			std::size_t i = first;
+			std::size_t lastSpace = first;
 
-			for (; i < curStr.size(); ++i)
+			for (; i < size; ++i)
 			{
-				const wchar_t curChar = curStr[i];
+				const sf::Uint32 curChar = m_string[i];
 
-				x += m_font->getKerning(prevChar, curChar, m_fontSize);
-				prevChar = curChar;
+				if (i > first)
+					x += m_characters[i].kerning;
 
 				if (curChar == L' ')
 				{
@@ -134,7 +173,7 @@ void Label::updateTexts() const
 					break;
 				}
 
-				const sf::Glyph& glyph = m_font->getGlyph(curChar, m_fontSize, false);
+				const sf::Glyph& glyph = *m_characters[i].glyph;
 
 				// if (x + glyph.bounds.left + glyph.bounds.width > width)
 				if (x + glyph.bounds.width > width)
@@ -143,54 +182,145 @@ void Label::updateTexts() const
 				x += glyph.advance;
 			}
 
-			if (i != curStr.size() && lastSpace > 0)
+			if (i != size && lastSpace > first)
 				i = lastSpace;
 
-			m_texts.emplace_back(curStr.substr(0, i), *m_font, m_fontSize);
+			// a glyph wider than the label
+			else if (i == first && m_string[i] != L'\n')
+				++i;
+
+			m_lines.push_back({ first, i });
 
-			if (curStr[i] == L' ' || curStr[i] == L'\t' || curStr[i] == L'\n')
+			if (i < size && !m_characters[i].glyph)
 				++i;
 
-			curStr = curStr.substr(i);
+			first = i;
 		}
 	}
 
-	// apply color and alignment
-	for (std::size_t i = 0; i < m_texts.size(); ++i)
+	m_linesNeedUpdate = false;
+	m_verticesNeedUpdate = true;
+}
+
+void Label::updateVertices() const
+{
+	m_vertices.clear();
+	m_vertices.reserve(m_characters.size() * 4);
+
+	const float whitespaceWidth = m_font->getGlyph(L' ', m_fontSize, false).advance;
+	const float lineSpacing = m_font->getLineSpacing(m_fontSize);
+
+	// align the lines vertically at cap height and baseline, as centerOriginA and setAnchorA
+	const sf::Glyph& capital = m_font->getGlyph(L'A', m_fontSize, false);
+	const float originY = std::floor(m_fontSize + capital.bounds.top + capital.bounds.height / 2);
+
+	float anchorX = 0.5f;
+	float positionX = std::floor(m_size.x * TileSize.x / 2.f);
+
+	if (m_alignment == Alignment::Left)
 	{
-		m_texts[i].setFillColor(m_color);
+		anchorX = 0.f;
+		positionX = 0.f;
+	}
 
-		if (m_alignment == Alignment::Centered)
-		{
-			centerOriginA(m_texts[i]);
-			m_texts[i].setPosition(std::floor(m_size.x * TileSize.x / 2.f), std::floor((i + 0.5f) * TileSize.y));
-		}
+	else if (m_alignment == Alignment::Right)
+	{
+		anchorX = 1.f;
+		positionX = static_cast<float>(m_size.x * TileSize.x);
+	}
 
-		else if (m_alignment == Alignment::Left)
-		{
-			setAnchorA(m_texts[i], { 0.f, 0.5f });
-			m_texts[i].setPosition(0.f, std::floor((i + 0.5f) * TileSize.y));
-		}
+	for (std::size_t n = 0; n < m_lines.size(); ++n)
+	{
+		const Line& line = m_lines[n];
+		const std::size_t firstVertex = m_vertices.size();
+
+		// same layout and horizontal bounds as sf::Text
+		float x = 0.f;
+		float y = static_cast<float>(m_fontSize);
+		float minX = static_cast<float>(m_fontSize);
+		float maxX = 0.f;
 
-		else // Alignment::Right
+		for (std::size_t i = line.first; i < line.last; ++i)
 		{
-			setAnchorA(m_texts[i], { 1.f, 0.5f });
-			m_texts[i].setPosition(static_cast<float>(m_size.x * TileSize.x), std::floor((i + 0.5f) * TileSize.y));
+			const sf::Uint32 curChar = m_string[i];
+			const Character& character = m_characters[i];
+
+			if (i > line.first)
+				x += character.kerning;
+
+			if (!character.glyph)
+			{
+				minX = std::min(minX, x);
+
+				if (curChar == L' ')
+					x += whitespaceWidth;
+				else if (curChar == L'\t')
+					x += whitespaceWidth * 4;
+				else // L'\n'
+				{
+					y += lineSpacing;
+					x = 0.f;
+				}
+
+				maxX = std::max(maxX, x);
+				continue;
+			}
+
+			const sf::Glyph& glyph = *character.glyph;
+
+			// NOTE: one pixel of padding around the glyphs, as sf::Text
+			const float padding = 1.f;
+
+			const float x1 = x + glyph.bounds.left - padding;
+			const float y1 = y + glyph.bounds.top - padding;
+			const float x2 = x + glyph.bounds.left + glyph.bounds.width + padding;
+			const float y2 = y + glyph.bounds.top + glyph.bounds.height + padding;
+
+			const float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+			const float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+			const float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+			const float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+			m_vertices.emplace_back(sf::Vector2f(x1, y1), m_color, sf::Vector2f(u1, v1));
+			m_vertices.emplace_back(sf::Vector2f(x2, y1), m_color, sf::Vector2f(u2, v1));
+			m_vertices.emplace_back(sf::Vector2f(x2, y2), m_color, sf::Vector2f(u2, v2));
+			m_vertices.emplace_back(sf::Vector2f(x1, y2), m_color, sf::Vector2f(u1, v2));
+
+			minX = std::min(minX, x + glyph.bounds.left);
+			maxX = std::max(maxX, x + glyph.bounds.left + glyph.bounds.width);
+
+			x += glyph.advance;
 		}
+
+		// empty text has empty bounds
+		if (line.first == line.last)
+			minX = maxX = 0.f;
+
+		const float originX = std::floor(minX + (maxX - minX) * anchorX);
+		const sf::Vector2f offset(positionX - originX, std::floor((n + 0.5f) * TileSize.y) - originY);
+
+		for (std::size_t i = firstVertex; i < m_vertices.size(); ++i)
+			m_vertices[i].position += offset;
 	}
 
-	m_textsNeedUpdate = false;
+	m_verticesNeedUpdate = false;
 }
 
 void Label::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-	if (m_textsNeedUpdate)
-		updateTexts();
+	if (m_linesNeedUpdate)
+		updateLines();
+
+	if (m_verticesNeedUpdate)
+		updateVertices();
+
+	if (m_vertices.empty())
+		return;
 
 	states.transform *= getTransform();
+	states.texture = &m_font->getTexture(m_fontSize);
 
-	for (const auto& text : m_texts)
-		target.draw(text, states);
+	target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, states);
 }
 
 /*
@@ -0,0 +1,502 @@
+#include "GUI/ListBox.hpp"
+#include "GUI/QuadBatch.hpp"
+#include "Console.hpp"
+
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace rl
+{
+
+sf::Color ListBox::s_selectionColor(94, 166, 50, 128);
+
+ListBox::ListBox(const sf::Font& font, int fontSize, const sf::Vector2i& size, std::size_t capacity)
+	: m_font(&font)
+	, m_fontSize(fontSize)
+	, m_size(size)
+{
+	setCapacity(capacity);
+}
+
+ListBox::ListBox(const sf::Vector2i& size, std::size_t capacity)
+	: ListBox(*getFont(), getFontSize(), size, capacity)
+{
+}
+
+const sf::Vector2i& ListBox::getSize() const
+{
+	return m_size;
+}
+
+void ListBox::setSize(const sf::Vector2i& size)
+{
+	m_size = size;
+	m_rows.clear();
+
+	clampScroll();
+}
+
+std::size_t ListBox::getCapacity() const
+{
+	return m_entries.size();
+}
+
+void ListBox::setCapacity(std::size_t capacity)
+{
+	assert(capacity > 0);
+
+	const std::size_t count = std::min(m_count, capacity);
+	const std::size_t first = m_first + m_count - count;
+
+	std::vector<Entry> entries(capacity);
+
+	for (std::size_t i = first; i < first + count; ++i)
+		entries[i % capacity] = std::move(getEntryAt(i));
+
+	m_entries = std::move(entries);
+	m_first = first;
+	m_count = count;
+
+	if (m_selected != None && m_selected < m_first)
+		m_selected = None;
+
+	clampScroll();
+}
+
+std::size_t ListBox::getEntryCount() const
+{
+	return m_count;
+}
+
+const std::wstring& ListBox::getEntry(std::size_t index) const
+{
+	assert(index < m_count);
+
+	return getEntryAt(m_first + index).string;
+}
+
+void ListBox::addEntry(const sf::String& string, const sf::Color& color)
+{
+	const bool follow = isScrolledToEnd();
+
+	// drop the oldest entry
+	if (m_count == m_entries.size())
+	{
+		if (m_selected == m_first)
+			m_selected = None;
+
+		++m_first;
+		--m_count;
+	}
+
+	getEntryAt(m_first + m_count) = { string.toWideString(), color };
+	++m_count;
+
+	if (follow)
+		scrollToEnd();
+	else
+		clampScroll();
+
+	m_verticesNeedUpdate = true;
+
+	markDirty();
+}
+
+void ListBox::setEntry(std::size_t index, const sf::String& string, const sf::Color& color)
+{
+	assert(index < m_count);
+
+	getEntryAt(m_first + index) = { string.toWideString(), color };
+
+	invalidateRow(m_first + index);
+}
+
+void ListBox::clear()
+{
+	// NOTE: sequence numbers go on, so the cached rows stay invalid
+	m_first += m_count;
+	m_count = 0;
+	m_scroll = m_first;
+	m_selected = None;
+	m_verticesNeedUpdate = true;
+
+	for (auto& entry : m_entries)
+		entry.string.clear();
+
+	markDirty();
+}
+
+std::size_t ListBox::getScroll() const
+{
+	return m_scroll - m_first;
+}
+
+void ListBox::setScroll(std::size_t index)
+{
+	m_scroll = m_first + index;
+
+	clampScroll();
+}
+
+void ListBox::scroll(int rows)
+{
+	if (rows < 0)
+		m_scroll -= std::min(m_scroll - m_first, static_cast<std::size_t>(-rows));
+	else
+		m_scroll += rows;
+
+	clampScroll();
+}
+
+void ListBox::scrollToEnd()
+{
+	m_scroll = m_first + m_count;
+
+	clampScroll();
+}
+
+int ListBox::getSelectedEntry() const
+{
+	return m_selected == None ? -1 : static_cast<int>(m_selected - m_first);
+}
+
+void ListBox::selectEntry(std::size_t index)
+{
+	assert(index < m_count);
+
+	m_selected = m_first + index;
+
+	// scroll the entry into view
+	const std::size_t rows = std::max(m_size.y, 1);
+
+	if (m_selected < m_scroll)
+		m_scroll = m_selected;
+	else if (m_selected >= m_scroll + rows)
+		m_scroll = m_selected - rows + 1;
+
+	clampScroll();
+}
+
+void ListBox::setCallback(Callback callback)
+{
+	m_callback = std::move(callback);
+}
+
+bool ListBox::isSelectable() const
+{
+	return m_selectable;
+}
+
+void ListBox::setSelectable(bool flag)
+{
+	m_selectable = flag;
+	m_verticesNeedUpdate = true;
+
+	markDirty();
+}
+
+bool ListBox::contains(const sf::Vector2f& point) const
+{
+	if (!m_selectable)
+		return false;
+
+	const sf::FloatRect bounds(0.f, 0.f, static_cast<float>(m_size.x * TileSize.x), static_cast<float>(m_size.y * TileSize.y));
+
+	return getTransform().transformRect(bounds).contains(point);
+}
+
+void ListBox::handleEvent(const sf::Event& event)
+{
+	if (event.type == sf::Event::KeyPressed)
+	{
+		const int selected = getSelectedEntry();
+		const int last = static_cast<int>(m_count) - 1;
+		int next = selected;
+
+		switch (event.key.code)
+		{
+		case sf::Keyboard::Escape:
+			deactivate();
+			return;
+
+		case sf::Keyboard::Up:
+			next = selected - 1;
+			break;
+
+		case sf::Keyboard::Down:
+			next = selected + 1;
+			break;
+
+		case sf::Keyboard::PageUp:
+			next = selected - m_size.y;
+			break;
+
+		case sf::Keyboard::PageDown:
+			next = selected + m_size.y;
+			break;
+
+		case sf::Keyboard::Home:
+			next = 0;
+			break;
+
+		case sf::Keyboard::End:
+			next = last;
+			break;
+
+		case sf::Keyboard::Enter:
+			if (m_selectable && selected >= 0 && m_callback)
+				m_callback(selected);
+			return;
+
+		default:
+			return;
+		}
+
+		if (!m_selectable)
+		{
+			// a log scrolls instead
+			if (event.key.code == sf::Keyboard::Home)
+				setScroll(0);
+			else if (event.key.code == sf::Keyboard::End)
+				scrollToEnd();
+			else
+				scroll(next - selected);
+		}
+
+		else if (m_count > 0)
+			selectEntry(std::clamp(next, 0, last));
+	}
+
+	else if (event.type == sf::Event::MouseWheelScrolled)
+		scroll(-static_cast<int>(event.mouseWheelScroll.delta));
+}
+
+void ListBox::appendQuads(QuadBatch& batch, const sf::Transform& transform) const
+{
+	if (m_verticesNeedUpdate)
+		updateVertices();
+
+	const sf::Transform combined = transform * getTransform();
+
+	batch.append(nullptr, m_selection.data(), m_selection.size(), combined);
+	batch.append(&m_font->getTexture(m_fontSize), m_vertices.data(), m_vertices.size(), combined);
+}
+
+void ListBox::draw(Console& console) const
+{
+	const sf::Vector2i& position = getPosition();
+
+	for (int y = 0; y < m_size.y; ++y)
+	{
+		const std::size_t sequence = m_scroll + y;
+		const bool visible = sequence < m_first + m_count;
+		const Entry* entry = visible ? &getEntryAt(sequence) : nullptr;
+
+		// NOTE: the rest of the row is cleared, the console may keep the cells of the last frame
+		int x = 0;
+
+		if (entry)
+		{
+			for (std::size_t i = 0; i < entry->string.size() && x < m_size.x && entry->string[i] != L'\n'; ++i)
+			{
+				if (entry->string[i] == L'\t')
+				{
+					for (int k = 0; k < 4 && x < m_size.x; ++k)
+						console.setChar(position.x + x++, position.y + y, L' ', entry->color);
+				}
+
+				else
+					console.setChar(position.x + x++, position.y + y, entry->string[i], entry->color);
+			}
+		}
+
+		for (; x < m_size.x; ++x)
+			console.setChar(position.x + x, position.y + y, L' ');
+
+		const bool selected = m_selectable && visible && sequence == m_selected;
+
+		console.setColor(position.x, position.y + y, m_size.x, 1, selected ? s_selectionColor : sf::Color::Transparent);
+	}
+}
+
+void ListBox::setSelectionColor(const sf::Color& color)
+{
+	s_selectionColor = color;
+}
+
+const ListBox::Entry& ListBox::getEntryAt(std::size_t sequence) const
+{
+	return m_entries[sequence % m_entries.size()];
+}
+
+ListBox::Entry& ListBox::getEntryAt(std::size_t sequence)
+{
+	return m_entries[sequence % m_entries.size()];
+}
+
+bool ListBox::isScrolledToEnd() const
+{
+	return m_scroll + std::max(m_size.y, 1) >= m_first + m_count;
+}
+
+void ListBox::clampScroll()
+{
+	const std::size_t rows = std::max(m_size.y, 1);
+	const std::size_t last = m_first + (m_count > rows ? m_count - rows : 0);
+
+	m_scroll = std::clamp(m_scroll, m_first, last);
+	m_verticesNeedUpdate = true;
+
+	markDirty();
+}
+
+void ListBox::invalidateRow(std::size_t sequence)
+{
+	if (!m_rows.empty())
+	{
+		Row& row = m_rows[sequence % m_rows.size()];
+
+		if (row.entry == sequence)
+			row.entry = None;
+	}
+
+	m_verticesNeedUpdate = true;
+
+	markDirty();
+}
+
+void ListBox::layoutRow(Row& row) const
+{
+	const Entry& entry = getEntryAt(row.entry);
+
+	row.vertices.clear();
+
+	const float width = static_cast<float>(m_size.x * TileSize.x);
+	const float whitespaceWidth = m_font->getGlyph(L' ', m_fontSize, false).advance;
+
+	// baseline of the first row, centered at cap height as Label
+	const sf::Glyph& capital = m_font->getGlyph(L'A', m_fontSize, false);
+	const float y = std::floor(TileSize.y / 2.f) - std::floor(capital.bounds.top + capital.bounds.height / 2);
+
+	float x = 0.f;
+	wchar_t prevChar = 0;
+
+	for (const wchar_t curChar : entry.string)
+	{
+		x += m_font->getKerning(prevChar, curChar, m_fontSize);
+		prevChar = curChar;
+
+		if (curChar == L' ')
+		{
+			x += whitespaceWidth;
+			continue;
+		}
+
+		else if (curChar == L'\t')
+		{
+			x += whitespaceWidth * 4;
+			continue;
+		}
+
+		else if (curChar == L'\n')
+			break;
+
+		const sf::Glyph& glyph = m_font->getGlyph(curChar, m_fontSize, false);
+
+		// clipped at the width
+		if (x + glyph.bounds.left + glyph.bounds.width > width)
+			break;
+
+		// NOTE: one pixel of padding around the glyphs, as sf::Text
+		const float padding = 1.f;
+
+		const float x1 = x + glyph.bounds.left - padding;
+		const float y1 = y + glyph.bounds.top - padding;
+		const float x2 = x + glyph.bounds.left + glyph.bounds.width + padding;
+		const float y2 = y + glyph.bounds.top + glyph.bounds.height + padding;
+
+		const float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+		const float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+		const float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+		const float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+		row.vertices.emplace_back(sf::Vector2f(x1, y1), entry.color, sf::Vector2f(u1, v1));
+		row.vertices.emplace_back(sf::Vector2f(x2, y1), entry.color, sf::Vector2f(u2, v1));
+		row.vertices.emplace_back(sf::Vector2f(x2, y2), entry.color, sf::Vector2f(u2, v2));
+		row.vertices.emplace_back(sf::Vector2f(x1, y2), entry.color, sf::Vector2f(u1, v2));
+
+		x += glyph.advance;
+	}
+}
+
+void ListBox::updateVertices() const
+{
+	const std::size_t rows = std::max(m_size.y, 0);
+
+	if (m_rows.size() != rows)
+		m_rows.assign(rows, Row());
+
+	m_vertices.clear();
+	m_selection.clear();
+
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		const std::size_t sequence = m_scroll + i;
+
+		if (sequence >= m_first + m_count)
+			break;
+
+		// NOTE: scrolling by n rows lays out n rows, the other rows are only copied
+		Row& row = m_rows[sequence % rows];
+
+		if (row.entry != sequence)
+		{
+			row.entry = sequence;
+			layoutRow(row);
+		}
+
+		const float offset = static_cast<float>(i * TileSize.y);
+
+		for (sf::Vertex vertex : row.vertices)
+		{
+			vertex.position.y += offset;
+			m_vertices.push_back(vertex);
+		}
+
+		if (m_selectable && sequence == m_selected)
+		{
+			const float x2 = static_cast<float>(m_size.x * TileSize.x);
+			const float y2 = offset + TileSize.y;
+
+			m_selection.emplace_back(sf::Vector2f(0.f, offset), s_selectionColor);
+			m_selection.emplace_back(sf::Vector2f(x2, offset), s_selectionColor);
+			m_selection.emplace_back(sf::Vector2f(x2, y2), s_selectionColor);
+			m_selection.emplace_back(sf::Vector2f(0.f, y2), s_selectionColor);
+		}
+	}
+
+	m_verticesNeedUpdate = false;
+}
+
+void ListBox::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	if (m_verticesNeedUpdate)
+		updateVertices();
+
+	states.transform *= getTransform();
+
+	if (!m_selection.empty())
+		target.draw(&m_selection[0], m_selection.size(), sf::Quads, states);
+
+	states.texture = &m_font->getTexture(m_fontSize);
+
+	if (!m_vertices.empty())
+		target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, states);
+}
+
+}
@@ -0,0 +1,167 @@
+#include "GUI/QuadBatch.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+namespace rl
+{
+
+void QuadBatch::clear()
+{
+	m_segments.clear();
+}
+
+void QuadBatch::append(const sf::Texture* texture, const sf::Vertex* vertices, std::size_t vertexCount, const sf::Transform& transform)
+{
+	if (vertexCount == 0)
+		return;
+
+	std::vector<sf::Vertex>& layer = getVertices(texture);
+
+	for (std::size_t i = 0; i < vertexCount; ++i)
+	{
+		layer.push_back(vertices[i]);
+		layer.back().position = transform.transformPoint(vertices[i].position);
+	}
+}
+
+void QuadBatch::append(const sf::Text& text, const sf::Transform& transform)
+{
+	const sf::Font* font = text.getFont();
+	const sf::String& string = text.getString();
+
+	if (!font || string.isEmpty())
+		return;
+
+	// NOTE: only regular text is converted to quads
+	if (text.getStyle() != sf::Text::Regular || text.getOutlineThickness() != 0.f)
+	{
+		append(static_cast<const sf::Drawable&>(text), transform);
+		return;
+	}
+
+	// same geometry as sf::Text
+	const unsigned int fontSize = text.getCharacterSize();
+	const sf::Transform combined = transform * text.getTransform();
+	const sf::Color& color = text.getFillColor();
+
+	float whitespaceWidth = font->getGlyph(L' ', fontSize, false).advance;
+	const float letterSpacing = (whitespaceWidth / 3.f) * (text.getLetterSpacing() - 1.f);
+	whitespaceWidth += letterSpacing;
+	const float lineSpacing = font->getLineSpacing(fontSize) * text.getLineSpacing();
+
+	std::vector<sf::Vertex>& layer = getVertices(&font->getTexture(fontSize));
+
+	float x = 0.f;
+	float y = static_cast<float>(fontSize);
+	sf::Uint32 prevChar = 0;
+
+	for (std::size_t i = 0; i < string.getSize(); ++i)
+	{
+		const sf::Uint32 curChar = string[i];
+
+		if (curChar == L'\r')
+			continue;
+
+		x += font->getKerning(prevChar, curChar, fontSize);
+		prevChar = curChar;
+
+		if (curChar == L' ')
+		{
+			x += whitespaceWidth;
+			continue;
+		}
+
+		else if (curChar == L'\t')
+		{
+			x += whitespaceWidth * 4;
+			continue;
+		}
+
+		else if (curChar == L'\n')
+		{
+			y += lineSpacing;
+			x = 0.f;
+			continue;
+		}
+
+		const sf::Glyph& glyph = font->getGlyph(curChar, fontSize, false);
+
+		// NOTE: one pixel of padding around the glyphs, as sf::Text
+		const float padding = 1.f;
+
+		const float x1 = x + glyph.bounds.left - padding;
+		const float y1 = y + glyph.bounds.top - padding;
+		const float x2 = x + glyph.bounds.left + glyph.bounds.width + padding;
+		const float y2 = y + glyph.bounds.top + glyph.bounds.height + padding;
+
+		const float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+		const float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+		const float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+		const float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+		layer.emplace_back(combined.transformPoint(x1, y1), color, sf::Vector2f(u1, v1));
+		layer.emplace_back(combined.transformPoint(x2, y1), color, sf::Vector2f(u2, v1));
+		layer.emplace_back(combined.transformPoint(x2, y2), color, sf::Vector2f(u2, v2));
+		layer.emplace_back(combined.transformPoint(x1, y2), color, sf::Vector2f(u1, v2));
+
+		x += glyph.advance + letterSpacing;
+	}
+}
+
+void QuadBatch::append(const sf::Drawable& drawable, const sf::Transform& transform)
+{
+	m_segments.emplace_back();
+	m_segments.back().drawable = &drawable;
+	m_segments.back().transform = transform;
+}
+
+std::size_t QuadBatch::getDrawCallCount() const
+{
+	std::size_t count = 0;
+
+	for (const auto& segment : m_segments)
+		count += segment.drawable ? 1 : segment.layers.size();
+
+	return count;
+}
+
+std::vector<sf::Vertex>& QuadBatch::getVertices(const sf::Texture* texture)
+{
+	if (m_segments.empty() || m_segments.back().drawable)
+		m_segments.emplace_back();
+
+	std::vector<Layer>& layers = m_segments.back().layers;
+
+	// NOTE: only consecutive quads of the same texture are merged, the submission order is the drawing order
+	if (layers.empty() || layers.back().texture != texture)
+		layers.push_back({ texture, {} });
+
+	return layers.back().vertices;
+}
+
+void QuadBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	for (const auto& segment : m_segments)
+	{
+		if (segment.drawable)
+		{
+			sf::RenderStates drawableStates = states;
+			drawableStates.transform *= segment.transform;
+
+			target.draw(*segment.drawable, drawableStates);
+			continue;
+		}
+
+		for (const auto& layer : segment.layers)
+		{
+			if (layer.vertices.empty())
+				continue;
+
+			states.texture = layer.texture;
+			target.draw(&layer.vertices[0], layer.vertices.size(), sf::Quads, states);
+		}
+	}
+}
+
+}
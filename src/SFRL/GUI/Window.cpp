@@ -1,4 +1,5 @@
 #include "GUI/Window.hpp"
+#include "GUI/QuadBatch.hpp"
 #include "Utility.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -21,12 +22,16 @@ void Window::setSize(const sf::Vector2i& size)
 {
 	m_size = size;
 	m_verticesNeedUpdate = true;
+
+	markDirty();
 }
 
 void Window::setFrameColor(const sf::Color& color)
 {
 	m_frameColor = color;
 	m_verticesNeedUpdate = true;
+
+	markDirty();
 }
 
 void Window::setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize, int tileBegin)
@@ -35,6 +40,8 @@ void Window::setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize
 	m_tileSize = tileSize;
 	m_tileBegin = tileBegin;
 	m_verticesNeedUpdate = true;
+
+	markDirty();
 }
 
 sf::Text& Window::setTitle(const sf::String& string, const sf::Font& font, int fontSize)
@@ -47,6 +54,8 @@ sf::Text& Window::setTitle(const sf::String& string, const sf::Font& font, int f
 
 	m_verticesNeedUpdate = true;
 
+	markDirty();
+
 	return *m_title;
 }
 
@@ -60,6 +69,19 @@ int Window::getTitleLength() const
 	return m_titleLength;
 }
 
+void Window::appendQuads(QuadBatch& batch, const sf::Transform& transform) const
+{
+	if (m_verticesNeedUpdate)
+		updateVertices();
+
+	const sf::Transform combined = transform * getTransform();
+
+	batch.append(m_texture, m_vertices.data(), m_vertices.size(), combined);
+
+	if (m_title)
+		batch.append(*m_title, combined);
+}
+
 void Window::updateVertices() const
 {
 	// UNDONE: auto resize the window
@@ -0,0 +1,272 @@
+#include "Map/ChunkGenerator.hpp"
+
+#include <cassert>
+
+namespace
+{
+	// murmur3 finalizer
+	unsigned int mix(unsigned int h)
+	{
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+
+		return h;
+	}
+
+	enum Salt : unsigned int
+	{
+		Chunk,
+		Noise,
+		VerticalEdge,
+		HorizontalEdge,
+		Hub,
+	};
+}
+
+namespace rl
+{
+
+ChunkGenerator::ChunkGenerator(unsigned int worldSeed, int chunkSize, int halo)
+	: m_worldSeed(worldSeed)
+	, m_chunkSize(chunkSize)
+	, m_halo(halo)
+{
+	assert(chunkSize > 2 && halo >= MinHalo);
+
+	// overworld: land and lakes
+	m_wall = Tile::Water;
+}
+
+unsigned int ChunkGenerator::getWorldSeed() const
+{
+	return m_worldSeed;
+}
+
+int ChunkGenerator::getChunkSize() const
+{
+	return m_chunkSize;
+}
+
+void ChunkGenerator::generateChunk(Map& chunk, const sf::Vector2i& coords)
+{
+	const int size = m_chunkSize + m_halo * 2;
+
+	m_coords = coords;
+	m_origin = coords * m_chunkSize - Point(m_halo, m_halo);
+
+	Map map(size, size);
+	Rng rng(m_worldSeed, hash(coords.x, coords.y, Salt::Chunk));
+	generate(map, rng);
+
+	// crop the halo
+	chunk.resize(m_chunkSize, m_chunkSize);
+
+	for (int y = 0; y < m_chunkSize; ++y)
+		for (int x = 0; x < m_chunkSize; ++x)
+		{
+			chunk.setTile(x, y, map.getTile(x + m_halo, y + m_halo));
+			chunk.at(x, y) = map.at(x + m_halo, y + m_halo);
+		}
+}
+
+const sf::Vector2i& ChunkGenerator::getCoords() const
+{
+	return m_coords;
+}
+
+const MapGenerator::Point& ChunkGenerator::getOrigin() const
+{
+	return m_origin;
+}
+
+void ChunkGenerator::fillNoise(int wallProb)
+{
+	for (int y = 0; y < m_height; ++y)
+		for (int x = 0; x < m_width; ++x)
+		{
+			if (static_cast<int>(hash(m_origin.x + x, m_origin.y + y, Salt::Noise) % 100) < wallProb)
+				m_map->setTile(x, y, m_wall);
+			else
+				m_map->setTile(x, y, m_floor);
+		}
+}
+
+bool ChunkGenerator::getRoadCrossing(const Direction& dir, Point& inner, Point& outer) const
+{
+	// the edges are shared with the neighbor chunks (west edge of x + 1 == east edge of x)
+	const bool vertical = (dir == Direction::W || dir == Direction::E);
+	const int ex = m_coords.x + (dir == Direction::E ? 1 : 0);
+	const int ey = m_coords.y + (dir == Direction::S ? 1 : 0);
+	const unsigned int h = hash(ex, ey, vertical ? Salt::VerticalEdge : Salt::HorizontalEdge);
+
+	if (h % 100 >= 50)
+		return false;
+
+	const int margin = std::min(m_halo, m_chunkSize / 4);
+	const int length = m_halo - 2; // NOTE: the crossing and its wide passage stay in the halo of both chunks
+	const int offset = margin + static_cast<int>((h >> 8) % std::max(1, m_chunkSize - margin * 2));
+
+	// world position of the edge (the first tile after the edge) and the crossing
+	Point edge(ex * m_chunkSize, ey * m_chunkSize);
+	Point from, to;
+
+	if (vertical)
+	{
+		from = { edge.x - length, edge.y + offset };
+		to = { edge.x + length - 1, edge.y + offset };
+	}
+
+	else
+	{
+		from = { edge.x + offset, edge.y - length };
+		to = { edge.x + offset, edge.y + length - 1 };
+	}
+
+	// inner end of the crossing is inside the chunk
+	if (dir == Direction::E || dir == Direction::S)
+	{
+		inner = from - m_origin;
+		outer = to - m_origin;
+	}
+
+	else
+	{
+		inner = to - m_origin;
+		outer = from - m_origin;
+	}
+
+	return true;
+}
+
+void ChunkGenerator::carveRoads(int perturbation)
+{
+	const std::vector<Tile> tiles = getTiles();
+
+	const unsigned int h = hash(m_coords.x, m_coords.y, Salt::Hub);
+	const int spread = std::max(1, m_chunkSize / 2);
+
+	Point hub;
+	hub.x = m_halo + m_chunkSize / 4 + static_cast<int>(h % spread);
+	hub.y = m_halo + m_chunkSize / 4 + static_cast<int>((h >> 16) % spread);
+
+	for (const auto& dir : Direction::Cardinal)
+	{
+		Point inner, outer;
+
+		if (!getRoadCrossing(dir, inner, outer))
+			continue;
+
+		carvePath(inner, outer);
+
+		// NOTE: the bends stay a tile away from the chunk edges, so the wide road is not cut by the crop
+		if (inner != hub)
+			carveWindingRoad(hub, inner, true, perturbation, { m_halo + 1, m_halo + 1, m_chunkSize - 2, m_chunkSize - 2 });
+	}
+
+	// roads over water are bridges
+	for (int y = 0; y < m_height; ++y)
+		for (int x = 0; x < m_width; ++x)
+		{
+			if (tiles[x + y * m_width] == m_water && m_map->getTile(x, y) == m_corridor)
+				m_map->setTile(x, y, m_bridge);
+		}
+}
+
+void ChunkGenerator::constructInnerBridges()
+{
+	const std::vector<Tile> tiles = getTiles();
+
+	constructBridges();
+
+	std::vector<Tile> result = getTiles();
+	std::vector<bool> visited(result.size(), false);
+
+	const auto isBuilt = [&] (const Point& pos)
+	{
+		const std::size_t i = pos.x + pos.y * m_width;
+
+		return (result[i] == m_bridge || result[i] == m_corridor) && result[i] != tiles[i];
+	};
+
+	const sf::IntRect interior(m_halo, m_halo, m_chunkSize, m_chunkSize);
+
+	// a bridge (with the bridges next to it) is kept if it is inside the chunk
+	for (int y = 0; y < m_height; ++y)
+		for (int x = 0; x < m_width; ++x)
+		{
+			if (visited[x + y * m_width] || !isBuilt({ x, y }))
+				continue;
+
+			std::vector<Point> bridge;
+			std::vector<Point> open = { { x, y } };
+			bool inside = true;
+
+			visited[x + y * m_width] = true;
+
+			while (!open.empty())
+			{
+				const Point pos = open.back();
+				open.pop_back();
+
+				bridge.emplace_back(pos);
+				inside = inside && interior.contains(pos);
+
+				for (const auto& dir : Direction::Cardinal)
+				{
+					const Point next = pos + dir;
+
+					if (m_map->isInBounds(next) && !visited[next.x + next.y * m_width] && isBuilt(next))
+					{
+						visited[next.x + next.y * m_width] = true;
+						open.emplace_back(next);
+					}
+				}
+			}
+
+			if (!inside)
+			{
+				for (const auto& pos : bridge)
+					result[pos.x + pos.y * m_width] = tiles[pos.x + pos.y * m_width];
+			}
+		}
+
+	// NOTE: the regions left unconnected (turned to water) may continue in the next chunk, they are kept
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		if (!visited[i])
+			result[i] = tiles[i];
+	}
+
+	setTiles(std::move(result));
+}
+
+unsigned int ChunkGenerator::hash(int x, int y, unsigned int salt) const
+{
+	unsigned int h = mix(m_worldSeed ^ salt * 0x9e3779b9u);
+	h = mix(h ^ static_cast<unsigned int>(x));
+	h = mix(h ^ static_cast<unsigned int>(y));
+
+	return h;
+}
+
+void ChunkGenerator::onGenerate()
+{
+	// NOTE: every generation() widens the unmatched border by its radius (2 + 2 + 1 + 1 <= halo)
+
+	fillNoise(40);
+	generation(5, 2);
+	generation(5, 2);
+	generation(5);
+	generation(5);
+	carveRoads();
+	constructInnerBridges();
+}
+
+void ChunkGenerator::onDecorate()
+{
+}
+
+}
@@ -0,0 +1,144 @@
+#include "Map/ChunkMap.hpp"
+
+#include <cassert>
+
+namespace
+{
+	int floorDiv(int a, int b)
+	{
+		return a / b - (a % b != 0 && (a < 0) != (b < 0));
+	}
+}
+
+namespace rl
+{
+
+ChunkMap::ChunkMap(Factory factory, int chunkSize, int radius)
+	: m_factory(std::move(factory))
+	, m_chunkSize(chunkSize)
+	, m_radius(radius)
+{
+	assert(chunkSize > 0 && radius >= 0);
+}
+
+ChunkMap::~ChunkMap()
+{
+	wait();
+}
+
+int ChunkMap::getChunkSize() const
+{
+	return m_chunkSize;
+}
+
+sf::Vector2i ChunkMap::toChunkCoords(const sf::Vector2i& position) const
+{
+	return { floorDiv(position.x, m_chunkSize), floorDiv(position.y, m_chunkSize) };
+}
+
+void ChunkMap::update(const sf::Vector2i& position)
+{
+	collect();
+
+	const sf::Vector2i center = toChunkCoords(position);
+
+	// release generated chunks outside the radius (+1 to avoid thrashing at the edges)
+	for (auto it = m_chunks.begin(); it != m_chunks.end(); )
+	{
+		const sf::Vector2i coords(static_cast<std::int32_t>(it->first >> 32), static_cast<std::int32_t>(it->first));
+		const int distance = std::max(std::abs(coords.x - center.x), std::abs(coords.y - center.y));
+
+		if (distance > m_radius + 1 && it->second.map)
+			it = m_chunks.erase(it);
+		else
+			++it;
+	}
+
+	for (int y = center.y - m_radius; y <= center.y + m_radius; ++y)
+		for (int x = center.x - m_radius; x <= center.x + m_radius; ++x)
+		{
+			const sf::Vector2i coords(x, y);
+			Chunk& chunk = m_chunks[toKey(coords)];
+
+			if (chunk.map || chunk.future.valid())
+				continue;
+
+			chunk.future = std::async(std::launch::async, [this, coords] ()
+			{
+				auto generator = m_factory();
+				assert(generator && generator->getChunkSize() == m_chunkSize);
+
+				auto map = std::make_unique<Map>(m_chunkSize, m_chunkSize);
+				generator->generateChunk(*map, coords);
+
+				return map;
+			});
+		}
+}
+
+void ChunkMap::wait()
+{
+	for (auto& [key, chunk] : m_chunks)
+	{
+		if (chunk.future.valid())
+			chunk.map = chunk.future.get();
+	}
+}
+
+std::size_t ChunkMap::getChunkCount() const
+{
+	return m_chunks.size();
+}
+
+bool ChunkMap::isLoaded(const sf::Vector2i& position) const
+{
+	return getChunk(toChunkCoords(position)) != nullptr;
+}
+
+const Map* ChunkMap::getChunk(const sf::Vector2i& coords) const
+{
+	const auto found = m_chunks.find(toKey(coords));
+
+	if (found == m_chunks.end())
+		return nullptr;
+
+	return found->second.map.get();
+}
+
+Tile ChunkMap::getTile(const sf::Vector2i& position) const
+{
+	const sf::Vector2i coords = toChunkCoords(position);
+	const Map* chunk = getChunk(coords);
+
+	if (!chunk)
+		return Tile::Unused;
+
+	return chunk->getTile(position - coords * m_chunkSize);
+}
+
+const Map::Flags* ChunkMap::at(const sf::Vector2i& position) const
+{
+	const sf::Vector2i coords = toChunkCoords(position);
+	const Map* chunk = getChunk(coords);
+
+	if (!chunk)
+		return nullptr;
+
+	return &chunk->at(position - coords * m_chunkSize);
+}
+
+std::uint64_t ChunkMap::toKey(const sf::Vector2i& coords)
+{
+	return static_cast<std::uint64_t>(static_cast<std::uint32_t>(coords.x)) << 32 | static_cast<std::uint32_t>(coords.y);
+}
+
+void ChunkMap::collect()
+{
+	for (auto& [key, chunk] : m_chunks)
+	{
+		if (chunk.future.valid() && chunk.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			chunk.map = chunk.future.get();
+	}
+}
+
+}
@@ -1,10 +1,12 @@
 #include "Map/Fov.hpp"
 #include "Map/Map.hpp"
 #include "Utility.hpp"
+#include "SoftwareTarget.hpp"
 
-#include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 
+#include <algorithm>
+
 namespace rl
 {
 
@@ -14,29 +16,47 @@ bool Fov::Shadow::contains(const Shadow& projection) const
 }
 
 Fov::Fov(const sf::Vector2i& tileSize, const sf::Texture* texture, int tileBegin)
-	: m_texture(texture)
-	, m_tileSize(tileSize)
-	, m_tileBegin(tileBegin)
 {
+	setTexture(tileSize, texture, tileBegin);
 }
 
 void Fov::setTexture(const sf::Vector2i& tileSize, const sf::Texture* texture, int tileBegin)
 {
-	m_texture = texture;
 	m_tileSize = tileSize;
 	m_tileBegin = tileBegin;
+	m_tileset = nullptr;
+	m_verticesNeedUpdate = true;
+
+	if (texture)
+	{
+		m_defaultTileset.setTexture(*texture, tileSize);
+		m_tileset = &m_defaultTileset;
+	}
+}
+
+void Fov::setTileset(const Tileset& tileset, int tileBegin)
+{
+	m_tileset = &tileset;
+	m_tileSize = tileset.getTileSize();
+	m_tileBegin = tileBegin;
+	m_verticesNeedUpdate = true;
 }
 
 void Fov::setMap(Map& map)
 {
 	m_map = &map;
 	m_viewRect = { 0, 0, map.width, map.height };
+	m_verticesNeedUpdate = true;
 }
 
 void Fov::setViewRect(const sf::IntRect& rect)
 {
+	// NOTE: scrolling keeps the quads that stay in view (the ones whose flags changed are rebuilt)
+	if (rect.width != m_viewRect.width || rect.height != m_viewRect.height)
+		m_verticesNeedUpdate = true;
+
 	m_viewRect = rect;
-	m_verticesNeedUpdate = true;
+	m_flagsChanged = true;
 }
 
 void Fov::clear()
@@ -45,7 +65,12 @@ void Fov::clear()
 		for (int x = 0; x < m_map->width; ++x)
 			m_map->at(x, y).visible = false;
 
-	m_verticesNeedUpdate = true;
+	m_flagsChanged = true;
+}
+
+void Fov::invalidate()
+{
+	m_flagsChanged = true;
 }
 
 void Fov::compute(const sf::Vector2i& position, int range)
@@ -60,7 +85,7 @@ void Fov::compute(const sf::Vector2i& position, int range)
 		for (int octant = 0; octant < 8; ++octant)
 			refreshOctant(octant, position, range + 1);
 
-		m_verticesNeedUpdate = true;
+		m_flagsChanged = true;
 	}
 }
 
@@ -194,209 +219,272 @@ bool Fov::isExplored(int x, int y) const
 	return !m_map->isInBounds(x, y) || m_map->at(x, y).explored;
 }
 
-void Fov::appendQuad(int x, int y, int tileOffset, const sf::Color& color) const
+std::uint32_t Fov::getSignature(int x, int y) const
+{
+	std::uint32_t signature = 0;
+
+	for (int j = y - 1; j <= y + 1; ++j)
+		for (int i = x - 1; i <= x + 1; ++i)
+			signature = (signature << 2) | (isVisible(i, j) ? 2 : 0) | (isExplored(i, j) ? 1 : 0);
+
+	return signature;
+}
+
+int Fov::getSlot(int x, int y) const
+{
+	const int i = x % m_viewRect.width;
+	const int j = y % m_viewRect.height;
+
+	return (i < 0 ? i + m_viewRect.width : i) + (j < 0 ? j + m_viewRect.height : j) * m_viewRect.width;
+}
+
+void Fov::setQuad(sf::Vertex* quad, int x, int y, int tileOffset, const sf::Color& color) const
 {
-	const auto [tv, tu] = std::div(m_tileBegin + tileOffset, m_texture->getSize().x / m_tileSize.x);
+	const Tileset::TexCoords& texCoords = m_tileset->getTexCoords(m_tileBegin + tileOffset);
 
 	const float x1 = (x + 0.f) * m_tileSize.x;
 	const float y1 = (y + 0.f) * m_tileSize.y;
 	const float x2 = (x + 1.f) * m_tileSize.x;
 	const float y2 = (y + 1.f) * m_tileSize.y;
 
-	const float u1 = (tu + 0.f) * m_tileSize.x + 0.0625f;
-	const float v1 = (tv + 0.f) * m_tileSize.y + 0.0625f;
-	const float u2 = (tu + 1.f) * m_tileSize.x - 0.0625f;
-	const float v2 = (tv + 1.f) * m_tileSize.y - 0.0625f;
+	quad[0] = sf::Vertex(sf::Vector2f(x1, y1), color, texCoords[0]);
+	quad[1] = sf::Vertex(sf::Vector2f(x2, y1), color, texCoords[1]);
+	quad[2] = sf::Vertex(sf::Vector2f(x2, y2), color, texCoords[2]);
+	quad[3] = sf::Vertex(sf::Vector2f(x1, y2), color, texCoords[3]);
+}
+
+sf::Vertex* Fov::appendEdges(sf::Vertex* quad, int x, int y, bool visible, const sf::Color& color) const
+{
+	const auto isSet = [this, visible] (int x, int y)
+	{
+		return visible ? isVisible(x, y) : isExplored(x, y);
+	};
+
+	int edges = 0;
+
+	if (isSet(x - 1, y))
+		edges += 1;
+	if (isSet(x + 1, y))
+		edges += 2;
+	if (isSet(x, y - 1))
+		edges += 4;
+	if (isSet(x, y + 1))
+		edges += 8;
 
-	m_vertices.emplace_back(sf::Vector2f(x1, y1), color, sf::Vector2f(u1, v1));
-	m_vertices.emplace_back(sf::Vector2f(x2, y1), color, sf::Vector2f(u2, v1));
-	m_vertices.emplace_back(sf::Vector2f(x2, y2), color, sf::Vector2f(u2, v2));
-	m_vertices.emplace_back(sf::Vector2f(x1, y2), color, sf::Vector2f(u1, v2));
+	const auto append = [&] (int tileOffset)
+	{
+		setQuad(quad, x, y, tileOffset, color);
+		quad += 4;
+	};
+
+	if (edges != 15)
+		append(edges);
+
+	if (edges & 1)
+	{
+		if ((edges & 4) && !isSet(x - 1, y - 1))
+			append(16);
+		if ((edges & 8) && !isSet(x - 1, y + 1))
+			append(16 + 1);
+	}
+
+	if (edges & 2)
+	{
+		if ((edges & 4) && !isSet(x + 1, y - 1))
+			append(16 + 2);
+		if ((edges & 8) && !isSet(x + 1, y + 1))
+			append(16 + 3);
+	}
+
+	return quad;
 }
 
-void Fov::updateVertices() const
+void Fov::updateCell(int x, int y) const
 {
-	m_vertices.clear();
-	m_vertices.resize(m_viewRect.width * m_viewRect.height * 4);
+	const int slot = getSlot(x, y);
+	const Map::Flags& flags = m_map->at(x, y);
 
-	if (!m_texture)
+	sf::Vertex* quad = &m_quads[slot * 4];
+
+	m_signatures[slot] = getSignature(x, y);
+
+	if (m_tileset)
 	{
-		for (int j = 0; j < m_viewRect.height; ++j)
-			for (int i = 0; i < m_viewRect.width; ++i)
-			{
-				const int x = m_viewRect.left + i;
-				const int y = m_viewRect.top + j;
+		sf::Vertex* edges = &m_edges[slot * MaxEdges * 4];
+		sf::Vertex* end = edges;
 
-				sf::Color color(0, 0, 0);
+		if (flags.visible)
+		{
+			end = appendEdges(end, x, y, true, { 255, 255, 255, 204 });
+			end = appendEdges(end, x, y, false);
+		}
 
-				if (m_map->at(x, y).visible)
-					continue; // color.a = 0;
-				else if (m_map->at(x, y).explored)
-					color.a = 204;
+		else if (flags.explored)
+			end = appendEdges(end, x, y, false);
 
-				sf::Vertex* quad = &m_vertices[(i + j * m_viewRect.width) * 4];
+		m_edgeCounts[slot] = static_cast<int>(end - edges) / 4;
+	}
 
-				quad[0].position = { (x + 0.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
-				quad[1].position = { (x + 1.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
-				quad[2].position = { (x + 1.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
-				quad[3].position = { (x + 0.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
+	if (flags.visible)
+	{
+		for (int k = 0; k < 4; ++k)
+			quad[k] = sf::Vertex();
 
-				quad[0].color = color;
-				quad[1].color = color;
-				quad[2].color = color;
-				quad[3].color = color;
-			}
+		return;
 	}
 
-	else
+	sf::Color color = m_tileset ? sf::Color(255, 255, 255) : sf::Color(0, 0, 0);
+
+	if (flags.explored)
+		color.a = 204;
+
+	quad[0].position = { (x + 0.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
+	quad[1].position = { (x + 1.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
+	quad[2].position = { (x + 1.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
+	quad[3].position = { (x + 0.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
+
+	quad[0].color = color;
+	quad[1].color = color;
+	quad[2].color = color;
+	quad[3].color = color;
+
+	if (m_tileset)
 	{
-		// TODO: improve performance
+		const Tileset::TexCoords& texCoords = m_tileset->getTexCoords(m_tileBegin + 15); // opaque
 
-		for (int j = 0; j < m_viewRect.height; ++j)
-			for (int i = 0; i < m_viewRect.width; ++i)
-			{
-				const int x = m_viewRect.left + i;
-				const int y = m_viewRect.top + j;
+		quad[0].texCoords = texCoords[0];
+		quad[1].texCoords = texCoords[1];
+		quad[2].texCoords = texCoords[2];
+		quad[3].texCoords = texCoords[3];
+	}
+}
 
-				int tileOffset = 15; // opaque
-				sf::Color color(255, 255, 255);
+void Fov::updateCells(int y, int left, int right) const
+{
+	for (int x = left; x < right; ++x)
+		updateCell(x, y);
+}
 
-				if (m_map->at(x, y).visible)
-				{
-					int visible = 0;
-
-					if (isVisible(x - 1, y))
-						visible += 1;
-					if (isVisible(x + 1, y))
-						visible += 2;
-					if (isVisible(x, y - 1))
-						visible += 4;
-					if (isVisible(x, y + 1))
-						visible += 8;
-
-					if (visible != 15)
-						appendQuad(x, y, visible, { 255, 255, 255, 204 });
-
-					if (visible & 1)
-					{
-						if ((visible & 4) && !isVisible(x - 1, y - 1))
-							appendQuad(x, y, 16, { 255, 255, 255, 204 });
-						if ((visible & 8) && !isVisible(x - 1, y + 1))
-							appendQuad(x, y, 16 + 1, { 255, 255, 255, 204 });
-					}
-
-					if (visible & 2)
-					{
-						if ((visible & 4) && !isVisible(x + 1, y - 1))
-							appendQuad(x, y, 16 + 2, { 255, 255, 255, 204 });
-						if ((visible & 8) && !isVisible(x + 1, y + 1))
-							appendQuad(x, y, 16 + 3, { 255, 255, 255, 204 });
-					}
-
-					int explored = 0;
-
-					if (isExplored(x - 1, y))
-						explored += 1;
-					if (isExplored(x + 1, y))
-						explored += 2;
-					if (isExplored(x, y - 1))
-						explored += 4;
-					if (isExplored(x, y + 1))
-						explored += 8;
-
-					if (explored != 15)
-						appendQuad(x, y, explored);
-
-					if (explored & 1)
-					{
-						if ((explored & 4) && !isExplored(x - 1, y - 1))
-							appendQuad(x, y, 16);
-						if ((explored & 8) && !isExplored(x - 1, y + 1))
-							appendQuad(x, y, 16 + 1);
-					}
-
-					if (explored & 2)
-					{
-						if ((explored & 4) && !isExplored(x + 1, y - 1))
-							appendQuad(x, y, 16 + 2);
-						if ((explored & 8) && !isExplored(x + 1, y + 1))
-							appendQuad(x, y, 16 + 3);
-					}
-
-					continue; // color.a = 0;
-				}
+void Fov::updateChangedCells(const sf::IntRect& rect) const
+{
+	// NOTE: the flags of the rect and its border are read once, the signatures are built from the rows
+	const int width = rect.width + 2;
+	m_flagRows.resize(width * (rect.height + 2));
 
-				else if (m_map->at(x, y).explored)
-				{
-					color.a = 204;
-
-					int explored = 0;
-
-					if (isExplored(x - 1, y))
-						explored += 1;
-					if (isExplored(x + 1, y))
-						explored += 2;
-					if (isExplored(x, y - 1))
-						explored += 4;
-					if (isExplored(x, y + 1))
-						explored += 8;
-
-					if (explored != 15)
-						appendQuad(x, y, explored);
-
-					if (explored & 1)
-					{
-						if ((explored & 4) && !isExplored(x - 1, y - 1))
-							appendQuad(x, y, 16);
-						if ((explored & 8) && !isExplored(x - 1, y + 1))
-							appendQuad(x, y, 16 + 1);
-					}
-
-					if (explored & 2)
-					{
-						if ((explored & 4) && !isExplored(x + 1, y - 1))
-							appendQuad(x, y, 16 + 2);
-						if ((explored & 8) && !isExplored(x + 1, y + 1))
-							appendQuad(x, y, 16 + 3);
-					}
-				}
+	// NOTE: outside the map, the tiles are visible and explored
+	std::fill(m_flagRows.begin(), m_flagRows.end(), std::uint8_t(3));
 
-				// if (tileOffset < 0)
-					// continue;
+	const int left = std::max(rect.left - 1, 0);
+	const int right = std::min(rect.left + rect.width + 1, m_map->width);
 
-				const auto [tv, tu] = std::div(m_tileBegin + tileOffset, m_texture->getSize().x / m_tileSize.x);
+	for (int j = 0; j < rect.height + 2; ++j)
+	{
+		const int y = rect.top - 1 + j;
+
+		if (y < 0 || y >= m_map->height)
+			continue;
 
-				sf::Vertex* quad = &m_vertices[(i + j * m_viewRect.width) * 4];
+		std::uint8_t* flagRow = &m_flagRows[left - (rect.left - 1) + j * width];
+		const Map::Flags* flags = &m_map->at(left, y);
 
-				quad[0].position = { (x + 0.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
-				quad[1].position = { (x + 1.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
-				quad[2].position = { (x + 1.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
-				quad[3].position = { (x + 0.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
+		for (int x = left; x < right; ++x, ++flags)
+			*flagRow++ = (flags->visible ? 2 : 0) | (flags->explored ? 1 : 0);
+	}
 
-				quad[0].color = color;
-				quad[1].color = color;
-				quad[2].color = color;
-				quad[3].color = color;
+	for (int j = 1; j <= rect.height; ++j)
+		for (int i = 1; i <= rect.width; ++i)
+		{
+			std::uint32_t signature = 0;
 
-				// NOTE: half pixel trick to avoid artifacts when scrolling or zooming (0.0625f)
-				quad[0].texCoords = { (tu + 0.f) * m_tileSize.x + 0.0625f, (tv + 0.f) * m_tileSize.y + 0.0625f };
-				quad[1].texCoords = { (tu + 1.f) * m_tileSize.x - 0.0625f, (tv + 0.f) * m_tileSize.y + 0.0625f };
-				quad[2].texCoords = { (tu + 1.f) * m_tileSize.x - 0.0625f, (tv + 1.f) * m_tileSize.y - 0.0625f };
-				quad[3].texCoords = { (tu + 0.f) * m_tileSize.x + 0.0625f, (tv + 1.f) * m_tileSize.y - 0.0625f };
+			for (int row = j - 1; row <= j + 1; ++row)
+			{
+				const std::uint8_t* flags = &m_flagRows[i - 1 + row * width];
+				signature = (signature << 6) | (flags[0] << 4) | (flags[1] << 2) | flags[2];
 			}
+
+			const int x = rect.left - 1 + i;
+			const int y = rect.top - 1 + j;
+
+			if (m_signatures[getSlot(x, y)] != signature)
+				updateCell(x, y);
+		}
+}
+
+void Fov::updateVertices() const
+{
+	const int width = m_viewRect.width;
+	const int height = m_viewRect.height;
+
+	if (m_verticesNeedUpdate)
+	{
+		m_quads.assign(width * height * 4, sf::Vertex());
+		m_edges.assign(m_tileset ? width * height * MaxEdges * 4 : 0, sf::Vertex());
+		m_edgeCounts.assign(m_tileset ? width * height : 0, 0);
+		m_signatures.assign(width * height, 0);
+		m_builtRect = {};
+		m_verticesNeedUpdate = false;
+	}
+
+	if (m_builtRect == m_viewRect && !m_flagsChanged)
+		return;
+
+	sf::IntRect built;
+	m_builtRect.intersects(m_viewRect, built);
+
+	// NOTE: the flags may also have been changed outside compute and clear (e.g. magic mapping, loading)
+	if (m_flagsChanged && built.width > 0 && built.height > 0)
+		updateChangedCells(built);
+
+	for (int y = m_viewRect.top; y < m_viewRect.top + height; ++y)
+	{
+		// newly exposed rows and columns
+		if (y < built.top || y >= built.top + built.height)
+			updateCells(y, m_viewRect.left, m_viewRect.left + width);
+
+		else
+		{
+			updateCells(y, m_viewRect.left, built.left);
+			updateCells(y, built.left + built.width, m_viewRect.left + width);
+		}
+	}
+
+	m_builtRect = m_viewRect;
+	m_flagsChanged = false;
+
+	// NOTE: only copies the used quads, the edges themselves were built above
+	m_vertices.clear();
+
+	for (std::size_t slot = 0; slot < m_edgeCounts.size(); ++slot)
+	{
+		const sf::Vertex* edges = &m_edges[slot * MaxEdges * 4];
+		m_vertices.insert(m_vertices.end(), edges, edges + m_edgeCounts[slot] * 4);
 	}
+}
 
-	m_verticesNeedUpdate = false;
+void Fov::draw(SoftwareTarget& target, sf::RenderStates states) const
+{
+	render(target, states);
 }
 
 void Fov::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-	if (m_verticesNeedUpdate)
-		updateVertices();
+	render(target, states);
+}
+
+template <typename Target>
+void Fov::render(Target& target, sf::RenderStates states) const
+{
+	if (m_viewRect.width <= 0 || m_viewRect.height <= 0)
+		return;
+
+	updateVertices();
 
 	states.transform *= getTransform();
-	states.texture = m_texture;
-	target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, states);
+	states.texture = m_tileset ? m_tileset->getTexture() : nullptr;
+	target.draw(&m_quads[0], m_quads.size(), sf::Quads, states);
+
+	if (!m_vertices.empty())
+		target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, states);
 }
 
 }
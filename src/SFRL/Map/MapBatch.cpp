@@ -0,0 +1,187 @@
+#include "Map/MapBatch.hpp"
+#include "Direction.hpp"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <queue>
+#include <cassert>
+
+namespace rl
+{
+
+MapBatch::MapBatch(Factory factory, const sf::Vector2i& mapSize)
+	: m_factory(std::move(factory))
+	, m_mapSize(mapSize)
+{
+}
+
+unsigned int MapBatch::getThreadCount() const
+{
+	if (m_threadCount > 0)
+		return m_threadCount;
+
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void MapBatch::setThreadCount(unsigned int count)
+{
+	m_threadCount = count;
+}
+
+MapBatch::Result MapBatch::generate(unsigned int seed) const
+{
+	Map map(m_mapSize);
+
+	return generate(seed, map);
+}
+
+MapBatch::Result MapBatch::generate(unsigned int seed, Map& map) const
+{
+	Result result;
+	result.seed = seed;
+
+	sf::Clock clock;
+
+	auto generator = m_factory();
+	assert(generator);
+
+	Rng rng(seed);
+	generator->generate(map, rng);
+
+	result.time = clock.getElapsedTime();
+	result.stages = generator->getStages();
+	result.hash = hash(map);
+	result.regionCount = countRegions(map);
+
+	int passable = 0;
+
+	for (int y = 0; y < map.height; ++y)
+		for (int x = 0; x < map.width; ++x)
+		{
+			if (map.at(x, y).passable)
+				++passable;
+		}
+
+	result.floorRatio = static_cast<float>(passable) / std::max(1, map.width * map.height);
+
+	return result;
+}
+
+std::vector<MapBatch::Result> MapBatch::run(unsigned int firstSeed, unsigned int count) const
+{
+	return run(firstSeed, count, getThreadCount());
+}
+
+std::vector<MapBatch::Result> MapBatch::run(unsigned int firstSeed, unsigned int count, unsigned int threadCount) const
+{
+	std::vector<Result> results(count);
+	std::atomic<unsigned int> next = 0;
+
+	// each map has its own generator, map and rng, results are written to their own slot
+	const auto work = [&] ()
+	{
+		for (unsigned int i = next++; i < count; i = next++)
+			results[i] = generate(firstSeed + i);
+	};
+
+	threadCount = std::clamp(threadCount, 1u, std::max(1u, count));
+
+	std::vector<std::thread> threads;
+
+	for (unsigned int i = 1; i < threadCount; ++i)
+		threads.emplace_back(work);
+
+	work();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return results;
+}
+
+std::vector<unsigned int> MapBatch::verify(unsigned int firstSeed, unsigned int count) const
+{
+	const std::vector<Result> first = run(firstSeed, count);
+	const std::vector<Result> rerun = run(firstSeed, count);
+	const std::vector<Result> single = run(firstSeed, count, 1);
+
+	std::vector<unsigned int> seeds;
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		if (first[i].hash != rerun[i].hash || first[i].hash != single[i].hash)
+			seeds.emplace_back(firstSeed + i);
+	}
+
+	return seeds;
+}
+
+std::uint64_t MapBatch::hash(const Map& map)
+{
+	// FNV-1a
+	std::uint64_t result = 14695981039346656037ull;
+
+	const auto combine = [&result] (unsigned int value)
+	{
+		result ^= value;
+		result *= 1099511628211ull;
+	};
+
+	combine(map.width);
+	combine(map.height);
+
+	for (int y = 0; y < map.height; ++y)
+		for (int x = 0; x < map.width; ++x)
+		{
+			const Map::Flags& flags = map.at(x, y);
+
+			combine(static_cast<unsigned int>(map.getTile(x, y)));
+			combine(flags.passable | flags.transparent << 1 | flags.visible << 2 | flags.explored << 3);
+		}
+
+	return result;
+}
+
+int MapBatch::countRegions(const Map& map)
+{
+	std::vector<bool> visited(map.width * map.height, false);
+	int regions = 0;
+
+	// non-recursive flood fill
+	for (int y = 0; y < map.height; ++y)
+		for (int x = 0; x < map.width; ++x)
+		{
+			if (!map.at(x, y).passable || visited[x + y * map.width])
+				continue;
+
+			regions += 1;
+
+			std::queue<sf::Vector2i> queue;
+			queue.emplace(x, y);
+			visited[x + y * map.width] = true;
+
+			while (!queue.empty())
+			{
+				const sf::Vector2i pos = queue.front();
+				queue.pop();
+
+				for (const auto& dir : Direction::Cardinal)
+				{
+					const sf::Vector2i next = pos + dir;
+
+					if (!map.isInBounds(next) || !map.at(next).passable || visited[next.x + next.y * map.width])
+						continue;
+
+					visited[next.x + next.y * map.width] = true;
+					queue.emplace(next);
+				}
+			}
+		}
+
+	return regions;
+}
+
+}
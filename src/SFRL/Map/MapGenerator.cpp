@@ -2,27 +2,186 @@
 #include "Direction.hpp"
 #include "Utility.hpp"
 
+#include <SFML/System/Clock.hpp>
+
 #include <queue>
 #include <list>
+#include <sstream>
+#include <typeinfo>
 #include <cassert>
 
+namespace
+{
+	// row prefix sums of non-wall tiles, O(room height) per query
+	// NOTE: rooms are at most 11 tiles high (3d3 + walls); a summed-area table has O(1) queries, but placing a room
+	//       would update all the sums right of and below it, slower on large maps with many rooms
+	class WallRowSums
+	{
+	public:
+		WallRowSums(const rl::Map& map, rl::Tile wall)
+			: m_map(map)
+			, m_wall(wall)
+			, m_stride(map.width + 1)
+			, m_sums(m_stride * map.height, 0)
+		{
+			for (int y = 0; y < map.height; ++y)
+				updateRow(y, 0);
+		}
+
+		// [left, right) x [top, bottom)
+		bool isWall(int left, int top, int right, int bottom) const
+		{
+			for (int y = top; y < bottom; ++y)
+			{
+				if (m_sums[right + y * m_stride] != m_sums[left + y * m_stride])
+					return false;
+			}
+
+			return true;
+		}
+
+		void update(const sf::IntRect& rect)
+		{
+			for (int y = rect.top; y < rect.top + rect.height; ++y)
+				updateRow(y, rect.left);
+		}
+
+	private:
+		void updateRow(int y, int left)
+		{
+			int* row = &m_sums[y * m_stride];
+
+			for (int x = left; x < m_map.width; ++x)
+				row[x + 1] = row[x] + (m_map.getTile(x, y) != m_wall ? 1 : 0);
+		}
+
+	private:
+		const rl::Map& m_map;
+		rl::Tile m_wall;
+		int m_stride;
+		std::vector<int> m_sums;
+	};
+}
+
 namespace rl
 {
 
+MapGenerator::StageCache::EntryPtr MapGenerator::StageCache::find(const std::string& key) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto found = m_entries.find(key);
+
+	if (found == m_entries.end())
+		return nullptr;
+
+	return found->second;
+}
+
+void MapGenerator::StageCache::insert(const std::string& key, EntryPtr entry)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries[key] = std::move(entry);
+}
+
+void MapGenerator::StageCache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries.clear();
+}
+
+std::size_t MapGenerator::StageCache::getSize() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_entries.size();
+}
+
 void MapGenerator::generate(Map& map, Rng& rng)
 {
 	m_map = &map;
 	m_rng = &rng;
 	m_width = map.width;
 	m_height = map.height;
+	m_stages.clear();
+
+	std::ostringstream oss;
+	oss << typeid(*this).name() << ' ' << rng.getSeed() << ' ' << m_width << 'x' << m_height;
+	m_stageKey = oss.str();
 
 	// TODO: save rng seed for tile map
 	// m_rng->printSeed();
 
+	sf::Clock clock;
+
 	onGenerate();
-	// onDecorate();
 
-	// initialize map flags
+	// time spent outside of stage()
+	sf::Time generateTime = clock.restart();
+
+	for (const auto& stage : m_stages)
+		generateTime -= stage.time;
+
+	m_stages.push_back({ "generate", generateTime });
+
+	initializeFlags();
+	m_stages.push_back({ "flags", clock.restart() });
+
+	onDecorate();
+	m_stages.push_back({ "decorate", clock.restart() });
+}
+
+const std::vector<MapGenerator::Stage>& MapGenerator::getStages() const
+{
+	return m_stages;
+}
+
+void MapGenerator::setStageCache(StageCache* cache)
+{
+	m_cache = cache;
+}
+
+void MapGenerator::stage(const std::string& name, const std::function<void()>& step, bool cacheable)
+{
+	m_stageKey += '/';
+	m_stageKey += name;
+
+	if (m_cache && cacheable)
+	{
+		// NOTE: restored right away, the code of onGenerate() between the stages sees the tiles and the rng
+		if (auto entry = m_cache->find(m_stageKey))
+		{
+			m_map->m_tiles = entry->tiles;
+			*m_rng = entry->rng;
+
+			m_stages.push_back({ name, sf::Time(), entry->changedTiles, true });
+			return;
+		}
+	}
+
+	const std::vector<Tile> tiles = m_map->m_tiles;
+	sf::Clock clock;
+
+	step();
+
+	Stage result = { name, clock.getElapsedTime() };
+
+	for (std::size_t i = 0; i < tiles.size(); ++i)
+	{
+		if (tiles[i] != m_map->m_tiles[i])
+			++result.changedTiles;
+	}
+
+	if (m_cache && cacheable)
+		m_cache->insert(m_stageKey, std::make_shared<StageCache::Entry>(StageCache::Entry{ m_map->m_tiles, *m_rng, result.changedTiles }));
+
+	m_stages.emplace_back(std::move(result));
+}
+
+void MapGenerator::initializeFlags()
+{
 	for (int y = 0; y < m_height; ++y)
 		for (int x = 0; x < m_width; ++x)
 		{
@@ -52,8 +211,6 @@ void MapGenerator::generate(Map& map, Rng& rng)
 				break;
 			}
 		}
-
-	onDecorate();
 }
 
 void MapGenerator::fill(Tile tile)
@@ -799,10 +956,13 @@ std::vector<MapGenerator::Room> MapGenerator::fillRandomRooms()
 {
 	// TODO: non-rectangular rooms
 
+	constexpr int MinRoomSize = 3; // 3d3
+
 	std::vector<Point> points;
 
-	for (int y = 1; y < m_height - 1; ++y)
-		for (int x = 1; x < m_width - 1; ++x)
+	// candidates too close to the edges cannot host even the smallest room
+	for (int y = 1; y < m_height - MinRoomSize; ++y)
+		for (int x = 1; x < m_width - MinRoomSize; ++x)
 		{
 			if (m_map->getTile(x, y) == m_wall)
 				points.emplace_back(x, y);
@@ -810,6 +970,7 @@ std::vector<MapGenerator::Room> MapGenerator::fillRandomRooms()
 
 	m_rng->shuffle(points);
 
+	WallRowSums sums(*m_map, m_wall);
 	std::vector<Room> rooms;
 
 	while (!points.empty())
@@ -817,6 +978,10 @@ std::vector<MapGenerator::Room> MapGenerator::fillRandomRooms()
 		const Point pos = points.back();
 		points.pop_back();
 
+		// skip candidates covered by previously placed rooms before rolling the dice
+		if (!sums.isWall(pos.x - 1, pos.y - 1, pos.x + MinRoomSize + 1, pos.y + MinRoomSize + 1))
+			continue;
+
 		Room room;
 		room.left   = pos.x;
 		room.top    = pos.y;
@@ -826,7 +991,8 @@ std::vector<MapGenerator::Room> MapGenerator::fillRandomRooms()
 		if (room.left + room.width >= m_width || room.top + room.height >= m_height)
 			continue;
 
-		if (canPlaceRoom(room))
+		// same as canPlaceRoom(room)
+		if (sums.isWall(room.left - 1, room.top - 1, room.left + room.width + 1, room.top + room.height + 1))
 		{
 			/*
 			// TODO: fix this later (incorrect?)
@@ -847,6 +1013,7 @@ std::vector<MapGenerator::Room> MapGenerator::fillRandomRooms()
 			*/
 			{
 				placeRoom(room);
+				sums.update(room);
 				rooms.emplace_back(std::move(room));
 			}
 		}
@@ -956,7 +1123,7 @@ void MapGenerator::carveCorridor(const Point& from, const Point& to)
 	// TODO: place doors
 }
 
-void MapGenerator::carveWindingRoad(const Point& from, const Point& to, bool widePassage, int perturbation)
+void MapGenerator::carveWindingRoad(const Point& from, const Point& to, bool widePassage, int perturbation, const Room& area)
 {
 	// credit: http://www.roguebasin.com/index.php?title=Winding_ways
 
@@ -1007,7 +1174,7 @@ void MapGenerator::carveWindingRoad(const Point& from, const Point& to, bool wid
 				const int lod2 = lengthSquared(rpos - line[ri - 1]);
 				const int hid2 = lengthSquared(rpos - line[ri + 1]);
 
-				if (!m_map->isInBounds(rpos) ||
+				if (!m_map->isInBounds(rpos) || (area.width > 0 && !area.contains(rpos)) ||
 					lod2 < mind2 || lod2 > maxd2 ||
 					hid2 < mind2 || hid2 > maxd2)
 					continue;
@@ -1,132 +1,697 @@
 #include "Map/TileMap.hpp"
 #include "Map/Map.hpp"
+#include "SoftwareTarget.hpp"
 
-#include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 
+#include <type_traits>
+#include <algorithm>
 #include <cassert>
 
+namespace
+{
+	// visible, explored, not explored (same as the Fov overlay: black with alpha 204 or 255)
+	const sf::Color Shades[] = { sf::Color(255, 255, 255), sf::Color(51, 51, 51), sf::Color(0, 0, 0) };
+	// the same shades drawn over the tiles
+	const sf::Color Overlays[] = { sf::Color::Transparent, sf::Color(0, 0, 0, 204), sf::Color(0, 0, 0, 255) };
+
+	// NOTE: the cache keeps premultiplied colors, so translucent texels are not blended twice
+	const sf::BlendMode CacheBlend(sf::BlendMode::SrcAlpha, sf::BlendMode::OneMinusSrcAlpha, sf::BlendMode::Add,
+		sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha, sf::BlendMode::Add);
+	const sf::BlendMode CompositeBlend(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha);
+}
+
 namespace rl
 {
 
 TileMap::TileMap(const sf::Texture& texture, const sf::Vector2i& tileSize)
-	: m_texture(&texture)
-	, m_tileSize(tileSize)
 {
+	setTexture(texture, tileSize);
+}
+
+TileMap::TileMap(const Tileset& tileset)
+{
+	setTileset(tileset);
 }
 
 void TileMap::setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize)
 {
-	m_texture = &texture;
-	m_tileSize = tileSize;
+	m_defaultTileset.setTexture(texture, tileSize);
+
+	setTileset(m_defaultTileset);
+}
+
+void TileMap::setTileset(const Tileset& tileset)
+{
+	m_tileset = &tileset;
+	m_tileSize = tileset.getTileSize();
+
+	invalidateChunks();
 }
 
 void TileMap::setMap(Map& map)
 {
 	m_map = &map;
 	m_viewRect = { 0, 0, map.width, map.height };
+
+	createChunks();
 }
 
 void TileMap::setViewRect(const sf::IntRect& rect)
 {
 	m_viewRect = rect;
-	m_verticesNeedUpdate = true;
 }
 
 void TileMap::setTiles(const std::vector<int>& tiles)
 {
 	m_tiles = &tiles;
-	m_verticesNeedUpdate = true;
+
+	invalidateChunks();
+}
+
+void TileMap::setFovHack(bool flag)
+{
+	m_fovHack = flag;
+
+	invalidateChunks();
+}
+
+void TileMap::setShading(bool flag)
+{
+	m_shading = flag;
+
+	invalidateChunks();
+}
+
+void TileMap::setCaching(bool flag)
+{
+	const bool shadingOver = isShadingOver();
+
+	m_caching = flag && sf::RenderTexture::isAvailable();
+
+	// the shading moves between the vertex colors and the overlay
+	if (isShadingOver() != shadingOver)
+		invalidateChunks();
+
+	if (!m_caching)
+	{
+		for (auto& chunk : m_chunks)
+			chunk.cache.reset();
+
+		m_cachePool.clear();
+	}
 }
 
 void TileMap::setProps(const std::vector<Prop>& props)
 {
+	clearProps();
+
 	m_props = &props;
-	m_verticesNeedUpdate = true;
+
+	if (m_map)
+		linkProps();
 }
 
-void TileMap::setFovHack(bool flag)
+void TileMap::addProp(const Prop& prop)
 {
-	m_fovHack = flag;
-	m_verticesNeedUpdate = true;
+	// NOTE: the chunks are created by setMap
+	if (!m_map)
+	{
+		m_pendingProps.push_back(prop);
+		return;
+	}
+
+	Chunk& chunk = getChunk(prop.position);
+
+	chunk.props.push_back(prop);
+	chunk.propsNeedUpdate = true;
+}
+
+bool TileMap::removeProp(const sf::Vector2i& position, int tileNumber)
+{
+	const auto matches = [&] (const Prop& prop)
+	{
+		return prop.position == position && prop.tileNumber == tileNumber;
+	};
+
+	if (!m_map)
+	{
+		const auto found = std::find_if(m_pendingProps.begin(), m_pendingProps.end(), matches);
+
+		if (found == m_pendingProps.end())
+			return false;
+
+		m_pendingProps.erase(found);
+
+		return true;
+	}
+
+	Chunk& chunk = getChunk(position);
+
+	const auto found = std::find_if(chunk.props.begin() + chunk.linkedCount, chunk.props.end(), matches);
+
+	if (found == chunk.props.end())
+		return false;
+
+	chunk.props.erase(found);
+	chunk.propsNeedUpdate = true;
+
+	return true;
+}
+
+void TileMap::clearProps()
+{
+	m_props = nullptr;
+	m_pendingProps.clear();
+
+	for (auto& chunk : m_chunks)
+	{
+		chunk.props.clear();
+		chunk.linkedCount = 0;
+		chunk.propsNeedUpdate = true;
+	}
 }
 
 void TileMap::updateTileMap()
 {
-	m_verticesNeedUpdate = true;
+	for (auto& chunk : m_chunks)
+		chunk.needsCheck = true;
+
+	if (m_map && m_props)
+		linkProps();
 }
 
-void TileMap::appendQuad(const sf::Vector2i& position, int tileNumber, const sf::Vector2f& offset) const
+void TileMap::updateTile(const sf::Vector2i& position)
 {
-	const auto [tv, tu] = std::div(tileNumber, m_texture->getSize().x / m_tileSize.x);
+	if (!m_map)
+		return;
 
-	const float x1 = (position.x + 0.f + offset.x) * m_tileSize.x;
-	const float y1 = (position.y + 0.f + offset.y) * m_tileSize.y;
-	const float x2 = (position.x + 1.f + offset.x) * m_tileSize.x;
-	const float y2 = (position.y + 1.f + offset.y) * m_tileSize.y;
+	getChunk(position).needsCheck = true;
+}
+
+void TileMap::createChunks()
+{
+	m_useVertexBuffer = sf::VertexBuffer::isAvailable();
+
+	// keep the props added before the map, or to the previous map
+	std::vector<Prop> props = std::move(m_pendingProps);
+	m_pendingProps.clear();
+
+	for (const auto& chunk : m_chunks)
+		props.insert(props.end(), chunk.props.begin() + chunk.linkedCount, chunk.props.end());
+
+	m_chunkCount.x = (m_map->width + ChunkSize - 1) / ChunkSize;
+	m_chunkCount.y = (m_map->height + ChunkSize - 1) / ChunkSize;
+
+	m_chunks.clear();
+	m_chunks.resize(m_chunkCount.x * m_chunkCount.y);
+
+	for (int cy = 0; cy < m_chunkCount.y; ++cy)
+		for (int cx = 0; cx < m_chunkCount.x; ++cx)
+		{
+			Chunk& chunk = m_chunks[cx + cy * m_chunkCount.x];
+
+			chunk.rect.left = cx * ChunkSize;
+			chunk.rect.top = cy * ChunkSize;
+			chunk.rect.width = std::min(ChunkSize, m_map->width - chunk.rect.left);
+			chunk.rect.height = std::min(ChunkSize, m_map->height - chunk.rect.top);
 
-	const float u1 = (tu + 0.f) * m_tileSize.x + 0.0625f;
-	const float v1 = (tv + 0.f) * m_tileSize.y + 0.0625f;
-	const float u2 = (tu + 1.f) * m_tileSize.x - 0.0625f;
-	const float v2 = (tv + 1.f) * m_tileSize.y - 0.0625f;
+			chunk.tiles.assign(chunk.rect.width * chunk.rect.height, -1);
+			chunk.shades.assign(chunk.tiles.size(), 0);
+			chunk.vertices.assign(chunk.tiles.size() * 4, sf::Vertex());
 
-	m_vertices.emplace_back(sf::Vector2f(x1, y1), sf::Vector2f(u1, v1));
-	m_vertices.emplace_back(sf::Vector2f(x2, y1), sf::Vector2f(u2, v1));
-	m_vertices.emplace_back(sf::Vector2f(x2, y2), sf::Vector2f(u2, v2));
-	m_vertices.emplace_back(sf::Vector2f(x1, y2), sf::Vector2f(u1, v2));
+			if (m_useVertexBuffer)
+			{
+				chunk.buffer.setPrimitiveType(sf::Quads);
+				chunk.buffer.setUsage(sf::VertexBuffer::Dynamic);
+				chunk.buffer.create(chunk.vertices.size());
+			}
+		}
+
+	if (m_props)
+		linkProps();
+
+	for (const Prop& prop : props)
+	{
+		if (m_map->isInBounds(prop.position))
+			addProp(prop);
+	}
 }
 
-void TileMap::updateVertices() const
+void TileMap::linkProps()
 {
-	// TODO: improve performance
+	std::vector<std::vector<Prop>> linked(m_chunks.size());
 
-	assert(m_tiles && m_props);
+	for (const Prop& prop : *m_props)
+	{
+		if (m_map->isInBounds(prop.position))
+			linked[prop.position.x / ChunkSize + prop.position.y / ChunkSize * m_chunkCount.x].push_back(prop);
+	}
 
-	m_vertices.clear();
-	m_vertices.resize(m_viewRect.width * m_viewRect.height * 4);
+	const auto equals = [] (const Prop& a, const Prop& b)
+	{
+		return a.tileNumber == b.tileNumber && a.position == b.position && a.offset == b.offset;
+	};
+
+	// NOTE: only the chunks whose props changed are rebuilt
+	for (std::size_t i = 0; i < m_chunks.size(); ++i)
+	{
+		Chunk& chunk = m_chunks[i];
+		const auto begin = chunk.props.begin();
 
-	for (int j = 0; j < m_viewRect.height; ++j)
-		for (int i = 0; i < m_viewRect.width; ++i)
+		if (std::equal(linked[i].begin(), linked[i].end(), begin, begin + chunk.linkedCount, equals))
+			continue;
+
+		chunk.props.erase(begin, begin + chunk.linkedCount);
+		chunk.props.insert(chunk.props.begin(), linked[i].begin(), linked[i].end());
+		chunk.linkedCount = linked[i].size();
+		chunk.propsNeedUpdate = true;
+	}
+}
+
+void TileMap::invalidateChunks()
+{
+	for (auto& chunk : m_chunks)
+	{
+		chunk.needsUpdate = true;
+		chunk.propsNeedUpdate = true;
+		chunk.shadesNeedUpdate = true;
+	}
+}
+
+TileMap::Chunk& TileMap::getChunk(const sf::Vector2i& position) const
+{
+	assert(m_map && m_map->isInBounds(position));
+
+	return m_chunks[position.x / ChunkSize + position.y / ChunkSize * m_chunkCount.x];
+}
+
+int TileMap::getShade(int x, int y) const
+{
+	if (!m_shading || m_map->at(x, y).visible)
+		return 0;
+
+	return m_map->at(x, y).explored ? 1 : 2;
+}
+
+void TileMap::checkChunk(Chunk& chunk) const
+{
+	for (int j = 0; j < chunk.rect.height && !chunk.needsUpdate; ++j)
+		for (int i = 0; i < chunk.rect.width; ++i)
 		{
-			const int x = m_viewRect.left + i;
-			const int y = m_viewRect.top + j;
+			const int x = chunk.rect.left + i;
+			const int y = chunk.rect.top + j;
+
+			const int index = i + j * chunk.rect.width;
+			const int tileNumber = (m_map->at(x, y).explored || m_fovHack) ? (*m_tiles)[x + y * m_map->width] : -1;
+
+			if (chunk.tiles[index] != tileNumber)
+			{
+				// explored flags change props too
+				chunk.needsUpdate = true;
+				chunk.propsNeedUpdate = true;
+				break;
+			}
+
+			if (chunk.shades[index] != getShade(x, y))
+			{
+				chunk.propsNeedUpdate = true;
+
+				// NOTE: the shading over the tiles changes alone, the tiles are checked further
+				if (isShadingOver())
+					chunk.shadesNeedUpdate = true;
+
+				else
+				{
+					chunk.needsUpdate = true;
+					break;
+				}
+			}
+		}
+
+	chunk.needsCheck = false;
+}
+
+void TileMap::updateChunk(Chunk& chunk) const
+{
+	for (int j = 0; j < chunk.rect.height; ++j)
+		for (int i = 0; i < chunk.rect.width; ++i)
+		{
+			const int x = chunk.rect.left + i;
+			const int y = chunk.rect.top + j;
+			const int index = i + j * chunk.rect.width;
+
+			sf::Vertex* quad = &chunk.vertices[index * 4];
+
+			// NOTE: the shade is kept for unexplored tiles too, checkChunk compares it
+			chunk.shades[index] = getShade(x, y);
 
 			if (!m_map->at(x, y).explored && !m_fovHack)
+			{
+				chunk.tiles[index] = -1;
+
+				// NOTE: degenerate quad keeps a fixed slot per tile, so a row of a chunk can be drawn alone
+				for (int k = 0; k < 4; ++k)
+					quad[k] = sf::Vertex();
+
 				continue;
+			}
 
-			const auto [tv, tu] = std::div((*m_tiles)[x + y * m_map->width], m_texture->getSize().x / m_tileSize.x);
+			chunk.tiles[index] = (*m_tiles)[x + y * m_map->width];
 
-			sf::Vertex* quad = &m_vertices[(i + j * m_viewRect.width) * 4];
+			const Tileset::TexCoords& texCoords = m_tileset->getTexCoords(chunk.tiles[index]);
+			const sf::Color& color = Shades[isShadingOver() ? 0 : chunk.shades[index]];
 
 			quad[0].position = { (x + 0.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
 			quad[1].position = { (x + 1.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y };
 			quad[2].position = { (x + 1.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
 			quad[3].position = { (x + 0.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y };
 
-			// NOTE: half pixel trick to avoid artifacts when scrolling or zooming (0.0625f)
-			quad[0].texCoords = { (tu + 0.f) * m_tileSize.x + 0.0625f, (tv + 0.f) * m_tileSize.y + 0.0625f };
-			quad[1].texCoords = { (tu + 1.f) * m_tileSize.x - 0.0625f, (tv + 0.f) * m_tileSize.y + 0.0625f };
-			quad[2].texCoords = { (tu + 1.f) * m_tileSize.x - 0.0625f, (tv + 1.f) * m_tileSize.y - 0.0625f };
-			quad[3].texCoords = { (tu + 0.f) * m_tileSize.x + 0.0625f, (tv + 1.f) * m_tileSize.y - 0.0625f };
+			quad[0].texCoords = texCoords[0];
+			quad[1].texCoords = texCoords[1];
+			quad[2].texCoords = texCoords[2];
+			quad[3].texCoords = texCoords[3];
+
+			quad[0].color = color;
+			quad[1].color = color;
+			quad[2].color = color;
+			quad[3].color = color;
 		}
 
-	for (const Prop& prop : *m_props)
+	if (m_useVertexBuffer)
+		chunk.buffer.update(chunk.vertices.data());
+
+	chunk.needsCheck = false;
+	chunk.needsUpdate = false;
+	chunk.shadesNeedUpdate = true;
+	chunk.cacheNeedsUpdate = true;
+}
+
+void TileMap::updateProps(Chunk& chunk) const
+{
+	chunk.propVertices.clear();
+	chunk.propIndices.clear();
+
+	for (const Prop& prop : chunk.props)
 	{
-		if (m_viewRect.contains(prop.position) && (m_map->at(prop.position).explored || m_fovHack))
-			appendQuad(prop.position, prop.tileNumber, prop.offset);
+		if (m_map->at(prop.position).explored || m_fovHack)
+		{
+			chunk.propIndices.push_back(static_cast<int>(chunk.propVertices.size()));
+			const sf::Color& color = Shades[getShade(prop.position.x, prop.position.y)];
+
+			appendQuad(chunk.propVertices, prop.position, prop.tileNumber, prop.offset, color);
+		}
+
+		else
+			chunk.propIndices.push_back(-1);
 	}
 
-	m_verticesNeedUpdate = false;
+	chunk.propsNeedUpdate = false;
+}
+
+void TileMap::updateShades(Chunk& chunk) const
+{
+	chunk.shadeVertices.clear();
+
+	for (int j = 0; j < chunk.rect.height; ++j)
+		for (int i = 0; i < chunk.rect.width; ++i)
+		{
+			const int x = chunk.rect.left + i;
+			const int y = chunk.rect.top + j;
+			const int index = i + j * chunk.rect.width;
+
+			chunk.shades[index] = getShade(x, y);
+
+			// NOTE: the tiles not drawn are not shaded either
+			if (chunk.tiles[index] < 0 || chunk.shades[index] == 0)
+				continue;
+
+			const sf::Color& color = Overlays[chunk.shades[index]];
+
+			chunk.shadeVertices.emplace_back(sf::Vector2f((x + 0.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y), color);
+			chunk.shadeVertices.emplace_back(sf::Vector2f((x + 1.f) * m_tileSize.x, (y + 0.f) * m_tileSize.y), color);
+			chunk.shadeVertices.emplace_back(sf::Vector2f((x + 1.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y), color);
+			chunk.shadeVertices.emplace_back(sf::Vector2f((x + 0.f) * m_tileSize.x, (y + 1.f) * m_tileSize.y), color);
+		}
+
+	chunk.shadesNeedUpdate = false;
+}
+
+bool TileMap::isShadingOver() const
+{
+	return m_shading && m_caching;
+}
+
+void TileMap::releaseCaches(int left, int top, int right, int bottom) const
+{
+	for (int cy = 0; cy < m_chunkCount.y; ++cy)
+		for (int cx = 0; cx < m_chunkCount.x; ++cx)
+		{
+			Chunk& chunk = m_chunks[cx + cy * m_chunkCount.x];
+
+			if (chunk.cache && (cx < left || cx > right || cy < top || cy > bottom))
+			{
+				m_cachePool.push_back(std::move(chunk.cache));
+				chunk.cacheNeedsUpdate = true;
+			}
+		}
+}
+
+bool TileMap::drawCachedChunk(Chunk& chunk, sf::RenderTarget& target, const sf::RenderStates& states) const
+{
+	sf::IntRect rect;
+
+	if (!chunk.rect.intersects(m_viewRect, rect))
+		return true;
+
+	if (!chunk.cache)
+	{
+		if (!m_cachePool.empty())
+		{
+			chunk.cache = std::move(m_cachePool.back());
+			m_cachePool.pop_back();
+		}
+
+		else
+			chunk.cache = std::make_unique<sf::RenderTexture>();
+
+		// NOTE: every cache has the size of a whole chunk, so they can be swapped between chunks
+		const sf::Vector2u size(ChunkSize * m_tileSize.x, ChunkSize * m_tileSize.y);
+
+		if (chunk.cache->getSize() != size && !chunk.cache->create(size.x, size.y))
+		{
+			chunk.cache.reset();
+			return false;
+		}
+
+		chunk.cacheNeedsUpdate = true;
+	}
+
+	const sf::Vector2f origin(chunk.rect.left * static_cast<float>(m_tileSize.x), chunk.rect.top * static_cast<float>(m_tileSize.y));
+
+	if (chunk.cacheNeedsUpdate)
+	{
+		sf::RenderStates cacheStates(CacheBlend);
+		cacheStates.transform.translate(-origin);
+		cacheStates.texture = m_tileset->getTexture();
+
+		chunk.cache->clear(sf::Color::Transparent);
+		chunk.cache->draw(chunk.vertices.data(), chunk.vertices.size(), sf::Quads, cacheStates);
+		chunk.cache->display();
+
+		chunk.cacheNeedsUpdate = false;
+	}
+
+	// the part of the chunk in view
+	const float x1 = static_cast<float>(rect.left * m_tileSize.x);
+	const float y1 = static_cast<float>(rect.top * m_tileSize.y);
+	const float x2 = static_cast<float>((rect.left + rect.width) * m_tileSize.x);
+	const float y2 = static_cast<float>((rect.top + rect.height) * m_tileSize.y);
+
+	const sf::Vertex quad[] =
+	{
+		sf::Vertex(sf::Vector2f(x1, y1), sf::Vector2f(x1 - origin.x, y1 - origin.y)),
+		sf::Vertex(sf::Vector2f(x2, y1), sf::Vector2f(x2 - origin.x, y1 - origin.y)),
+		sf::Vertex(sf::Vector2f(x2, y2), sf::Vector2f(x2 - origin.x, y2 - origin.y)),
+		sf::Vertex(sf::Vector2f(x1, y2), sf::Vector2f(x1 - origin.x, y2 - origin.y)),
+	};
+
+	sf::RenderStates cachedStates = states;
+	cachedStates.texture = &chunk.cache->getTexture();
+	cachedStates.blendMode = CompositeBlend;
+
+	target.draw(quad, 4, sf::Quads, cachedStates);
+
+	return true;
+}
+
+template <typename Target>
+void TileMap::drawChunk(const Chunk& chunk, Target& target, const sf::RenderStates& states) const
+{
+	sf::IntRect rect;
+
+	if (!chunk.rect.intersects(m_viewRect, rect))
+		return;
+
+	// the whole chunk or the visible part of each row
+	const bool whole = (rect == chunk.rect);
+	const int rows = whole ? 1 : rect.height;
+
+	for (int j = 0; j < rows; ++j)
+	{
+		const std::size_t first = whole ? 0 : ((rect.left - chunk.rect.left) + (rect.top - chunk.rect.top + j) * chunk.rect.width) * 4;
+		const std::size_t count = whole ? chunk.vertices.size() : rect.width * 4;
+
+		if constexpr (std::is_same_v<Target, sf::RenderTarget>)
+		{
+			if (m_useVertexBuffer)
+			{
+				target.draw(chunk.buffer, first, count, states);
+				continue;
+			}
+		}
+
+		target.draw(&chunk.vertices[first], count, sf::Quads, states);
+	}
+}
+
+void TileMap::appendQuad(std::vector<sf::Vertex>& vertices, const sf::Vector2i& position, int tileNumber, const sf::Vector2f& offset, const sf::Color& color) const
+{
+	const Tileset::TexCoords& texCoords = m_tileset->getTexCoords(tileNumber);
+
+	const float x1 = (position.x + 0.f + offset.x) * m_tileSize.x;
+	const float y1 = (position.y + 0.f + offset.y) * m_tileSize.y;
+	const float x2 = (position.x + 1.f + offset.x) * m_tileSize.x;
+	const float y2 = (position.y + 1.f + offset.y) * m_tileSize.y;
+
+	vertices.emplace_back(sf::Vector2f(x1, y1), color, texCoords[0]);
+	vertices.emplace_back(sf::Vector2f(x2, y1), color, texCoords[1]);
+	vertices.emplace_back(sf::Vector2f(x2, y2), color, texCoords[2]);
+	vertices.emplace_back(sf::Vector2f(x1, y2), color, texCoords[3]);
 }
 
 void TileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-	if (m_verticesNeedUpdate)
-		updateVertices();
+	render(target, states);
+}
+
+void TileMap::draw(SoftwareTarget& target, sf::RenderStates states) const
+{
+	render(target, states);
+}
+
+template <typename Target>
+void TileMap::render(Target& target, sf::RenderStates states) const
+{
+	assert(m_map && m_tiles && m_tileset);
 
 	states.transform *= getTransform();
-	states.texture = m_texture;
-	target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, states);
+	states.texture = m_tileset->getTexture();
+
+	// chunks overlapping the view rect
+	const int left = std::max(0, m_viewRect.left / ChunkSize);
+	const int top = std::max(0, m_viewRect.top / ChunkSize);
+	const int right = std::min(m_chunkCount.x - 1, (m_viewRect.left + m_viewRect.width - 1) / ChunkSize);
+	const int bottom = std::min(m_chunkCount.y - 1, (m_viewRect.top + m_viewRect.height - 1) / ChunkSize);
+
+	// NOTE: the software target has no render textures, it always draws the tiles
+	constexpr bool canCache = std::is_same_v<Target, sf::RenderTarget>;
+
+	if (canCache && m_caching)
+		releaseCaches(left, top, right, bottom);
+
+	for (int cy = top; cy <= bottom; ++cy)
+		for (int cx = left; cx <= right; ++cx)
+		{
+			Chunk& chunk = m_chunks[cx + cy * m_chunkCount.x];
+
+			if (chunk.needsCheck)
+				checkChunk(chunk);
+
+			if (chunk.needsUpdate)
+				updateChunk(chunk);
+
+			if constexpr (canCache)
+			{
+				if (m_caching && drawCachedChunk(chunk, target, states))
+					continue;
+			}
+
+			drawChunk(chunk, target, states);
+		}
+
+	// shading over all tiles, under the props
+	if (isShadingOver())
+	{
+		m_vertices.clear();
+
+		for (int cy = top; cy <= bottom; ++cy)
+			for (int cx = left; cx <= right; ++cx)
+			{
+				Chunk& chunk = m_chunks[cx + cy * m_chunkCount.x];
+
+				if (chunk.shadesNeedUpdate)
+					updateShades(chunk);
+
+				sf::IntRect rect;
+				chunk.rect.intersects(m_viewRect, rect);
+
+				if (rect == chunk.rect)
+					m_vertices.insert(m_vertices.end(), chunk.shadeVertices.begin(), chunk.shadeVertices.end());
+
+				else
+				{
+					for (std::size_t i = 0; i < chunk.shadeVertices.size(); i += 4)
+					{
+						const sf::Vector2f& position = chunk.shadeVertices[i].position;
+
+						if (m_viewRect.contains(static_cast<int>(position.x) / m_tileSize.x, static_cast<int>(position.y) / m_tileSize.y))
+							m_vertices.insert(m_vertices.end(), chunk.shadeVertices.begin() + i, chunk.shadeVertices.begin() + i + 4);
+					}
+				}
+			}
+
+		sf::RenderStates shadeStates = states;
+		shadeStates.texture = nullptr;
+
+		if (!m_vertices.empty())
+			target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, shadeStates);
+	}
+
+	// props over all tiles
+	m_vertices.clear();
+
+	for (int cy = top; cy <= bottom; ++cy)
+		for (int cx = left; cx <= right; ++cx)
+		{
+			Chunk& chunk = m_chunks[cx + cy * m_chunkCount.x];
+
+			if (chunk.propsNeedUpdate)
+				updateProps(chunk);
+
+			if (chunk.propVertices.empty())
+				continue;
+
+			sf::IntRect rect;
+			chunk.rect.intersects(m_viewRect, rect);
+
+			if (rect == chunk.rect)
+				m_vertices.insert(m_vertices.end(), chunk.propVertices.begin(), chunk.propVertices.end());
+
+			else
+			{
+				for (std::size_t i = 0; i < chunk.props.size(); ++i)
+				{
+					const int index = chunk.propIndices[i];
+
+					if (index >= 0 && m_viewRect.contains(chunk.props[i].position))
+						m_vertices.insert(m_vertices.end(), chunk.propVertices.begin() + index, chunk.propVertices.begin() + index + 4);
+				}
+			}
+		}
+
+	if (!m_vertices.empty())
+		target.draw(&m_vertices[0], m_vertices.size(), sf::Quads, states);
 }
 
 }
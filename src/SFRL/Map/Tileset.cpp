@@ -0,0 +1,88 @@
+#include "Map/Tileset.hpp"
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include <cassert>
+
+namespace rl
+{
+
+Tileset::Tileset(const sf::Texture& texture, const sf::Vector2i& tileSize)
+{
+	setTexture(texture, tileSize);
+}
+
+void Tileset::setTexture(const sf::Texture& texture, const sf::Vector2i& tileSize)
+{
+	m_texture = &texture;
+	m_tileSize = tileSize;
+
+	clear();
+	addSheet();
+}
+
+const sf::Texture* Tileset::getTexture() const
+{
+	return m_texture;
+}
+
+const sf::Vector2i& Tileset::getTileSize() const
+{
+	return m_tileSize;
+}
+
+int Tileset::addSheet(const sf::IntRect& area, int padding)
+{
+	assert(m_texture && m_tileSize.x > 0 && m_tileSize.y > 0);
+
+	sf::IntRect rect = area;
+
+	if (rect.width <= 0 || rect.height <= 0)
+		rect = { 0, 0, static_cast<int>(m_texture->getSize().x), static_cast<int>(m_texture->getSize().y) };
+
+	const int first = getTileCount();
+	const int columns = (rect.width + padding) / (m_tileSize.x + padding);
+	const int rows = (rect.height + padding) / (m_tileSize.y + padding);
+
+	m_texCoords.reserve(m_texCoords.size() + columns * rows);
+
+	for (int tv = 0; tv < rows; ++tv)
+		for (int tu = 0; tu < columns; ++tu)
+		{
+			const float left = static_cast<float>(rect.left + tu * (m_tileSize.x + padding));
+			const float top = static_cast<float>(rect.top + tv * (m_tileSize.y + padding));
+
+			// NOTE: half pixel trick to avoid artifacts when scrolling or zooming (0.0625f)
+			const float u1 = left + 0.0625f;
+			const float v1 = top + 0.0625f;
+			const float u2 = left + m_tileSize.x - 0.0625f;
+			const float v2 = top + m_tileSize.y - 0.0625f;
+
+			m_texCoords.push_back({ sf::Vector2f(u1, v1), sf::Vector2f(u2, v1), sf::Vector2f(u2, v2), sf::Vector2f(u1, v2) });
+		}
+
+	return first;
+}
+
+void Tileset::clear()
+{
+	m_texCoords.clear();
+}
+
+int Tileset::getTileCount() const
+{
+	return static_cast<int>(m_texCoords.size());
+}
+
+const Tileset::TexCoords& Tileset::getTexCoords(int tileNumber) const
+{
+	// NOTE: a tile outside the sheets samples the top-left texel
+	static const TexCoords empty = {};
+
+	if (tileNumber < 0 || tileNumber >= getTileCount())
+		return empty;
+
+	return m_texCoords[tileNumber];
+}
+
+}
@@ -0,0 +1,116 @@
+#include "RenderBenchmark.hpp"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <iomanip>
+
+namespace rl
+{
+
+RenderBenchmark::RenderBenchmark(const sf::Vector2u& size)
+	: m_target(size)
+{
+}
+
+SoftwareTarget& RenderBenchmark::getTarget()
+{
+	return m_target;
+}
+
+const std::vector<RenderBenchmark::Frame>& RenderBenchmark::run(int frameCount, const Script& script, const Draw& draw, const sf::Color& clearColor)
+{
+	m_frames.clear();
+	m_frames.reserve(frameCount);
+
+	sf::Clock clock;
+
+	for (int i = 0; i < frameCount; ++i)
+	{
+		Frame frame;
+
+		clock.restart();
+		script(i);
+		frame.update = clock.restart();
+
+		m_target.clear(clearColor);
+		draw(m_target);
+
+		frame.raster = m_target.getRasterTime();
+		frame.build = clock.getElapsedTime() - frame.raster;
+		frame.hash = m_target.getHash();
+
+		m_frames.push_back(frame);
+	}
+
+	return m_frames;
+}
+
+const std::vector<RenderBenchmark::Frame>& RenderBenchmark::getFrames() const
+{
+	return m_frames;
+}
+
+RenderBenchmark::Frame RenderBenchmark::getAverage() const
+{
+	Frame average;
+
+	if (m_frames.empty())
+		return average;
+
+	for (const auto& frame : m_frames)
+	{
+		average.update += frame.update;
+		average.build += frame.build;
+		average.raster += frame.raster;
+	}
+
+	const auto count = static_cast<sf::Int64>(m_frames.size());
+
+	average.update = sf::microseconds(average.update.asMicroseconds() / count);
+	average.build = sf::microseconds(average.build.asMicroseconds() / count);
+	average.raster = sf::microseconds(average.raster.asMicroseconds() / count);
+	average.hash = m_frames.back().hash;
+
+	return average;
+}
+
+std::vector<std::uint64_t> RenderBenchmark::getHashes() const
+{
+	std::vector<std::uint64_t> hashes;
+	hashes.reserve(m_frames.size());
+
+	for (const auto& frame : m_frames)
+		hashes.push_back(frame.hash);
+
+	return hashes;
+}
+
+int RenderBenchmark::compare(const std::vector<std::uint64_t>& hashes) const
+{
+	const std::size_t count = std::min(hashes.size(), m_frames.size());
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (hashes[i] != m_frames[i].hash)
+			return static_cast<int>(i);
+	}
+
+	if (hashes.size() != m_frames.size())
+		return static_cast<int>(count);
+
+	return -1;
+}
+
+void RenderBenchmark::print(std::ostream& stream) const
+{
+	const Frame average = getAverage();
+
+	stream << "frames: " << m_frames.size()
+		<< ", update: " << average.update.asMicroseconds() << " us"
+		<< ", build: " << average.build.asMicroseconds() << " us"
+		<< ", raster: " << average.raster.asMicroseconds() << " us"
+		<< ", last hash: " << std::hex << std::setw(16) << std::setfill('0') << average.hash << std::dec << std::setfill(' ') << '\n';
+}
+
+}
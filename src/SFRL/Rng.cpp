@@ -11,6 +11,18 @@ Rng::Rng(unsigned int seed)
 {
 }
 
+Rng::Rng(unsigned int seed, unsigned int stream)
+	: Rng([seed, stream] ()
+	{
+		std::seed_seq sequence = { seed, stream };
+		unsigned int result = 0;
+		sequence.generate(&result, &result + 1);
+
+		return result;
+	}())
+{
+}
+
 int Rng::getSeed() const
 {
 	return m_seed;
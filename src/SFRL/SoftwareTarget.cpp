@@ -0,0 +1,235 @@
+#include "SoftwareTarget.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	float edge(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& p)
+	{
+		return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+	}
+
+	// top-left fill rule, so triangles sharing an edge do not draw its pixels twice
+	bool isTopLeft(const sf::Vector2f& a, const sf::Vector2f& b)
+	{
+		return (a.y == b.y && b.x < a.x) || (b.y < a.y);
+	}
+}
+
+namespace rl
+{
+
+SoftwareTarget::SoftwareTarget(const sf::Vector2u& size)
+{
+	create(size);
+}
+
+void SoftwareTarget::create(const sf::Vector2u& size)
+{
+	m_size = size;
+	m_pixels.assign(size.x * size.y * 4, 0);
+	m_rasterTime = sf::Time::Zero;
+}
+
+const sf::Vector2u& SoftwareTarget::getSize() const
+{
+	return m_size;
+}
+
+void SoftwareTarget::setImage(const sf::Texture& texture, const sf::Image& image)
+{
+	m_images[&texture] = &image;
+}
+
+void SoftwareTarget::clear(const sf::Color& color)
+{
+	for (std::size_t i = 0; i < m_pixels.size(); i += 4)
+	{
+		m_pixels[i + 0] = color.r;
+		m_pixels[i + 1] = color.g;
+		m_pixels[i + 2] = color.b;
+		m_pixels[i + 3] = color.a;
+	}
+
+	m_rasterTime = sf::Time::Zero;
+}
+
+void SoftwareTarget::draw(const sf::Vertex* vertices, std::size_t vertexCount, sf::PrimitiveType type, const sf::RenderStates& states)
+{
+	assert(type == sf::Quads || type == sf::Triangles);
+
+	sf::Clock clock;
+
+	const sf::Image* image = nullptr;
+
+	if (states.texture)
+	{
+		const auto found = m_images.find(states.texture);
+
+		if (found != m_images.end())
+			image = found->second;
+	}
+
+	const auto transform = [&states] (sf::Vertex vertex)
+	{
+		vertex.position = states.transform.transformPoint(vertex.position);
+		return vertex;
+	};
+
+	if (type == sf::Quads)
+	{
+		for (std::size_t i = 0; i + 3 < vertexCount; i += 4)
+		{
+			const sf::Vertex v0 = transform(vertices[i + 0]);
+			const sf::Vertex v1 = transform(vertices[i + 1]);
+			const sf::Vertex v2 = transform(vertices[i + 2]);
+			const sf::Vertex v3 = transform(vertices[i + 3]);
+
+			drawTriangle(v0, v1, v2, image);
+			drawTriangle(v0, v2, v3, image);
+		}
+	}
+
+	else
+	{
+		for (std::size_t i = 0; i + 2 < vertexCount; i += 3)
+			drawTriangle(transform(vertices[i]), transform(vertices[i + 1]), transform(vertices[i + 2]), image);
+	}
+
+	m_rasterTime += clock.getElapsedTime();
+}
+
+sf::Color SoftwareTarget::getPixel(unsigned int x, unsigned int y) const
+{
+	assert(x < m_size.x && y < m_size.y);
+
+	const sf::Uint8* pixel = &m_pixels[(x + y * m_size.x) * 4];
+
+	return { pixel[0], pixel[1], pixel[2], pixel[3] };
+}
+
+const sf::Uint8* SoftwareTarget::getPixels() const
+{
+	return m_pixels.data();
+}
+
+std::uint64_t SoftwareTarget::getHash() const
+{
+	// FNV-1a
+	std::uint64_t result = 14695981039346656037ull;
+
+	for (const sf::Uint8 byte : m_pixels)
+	{
+		result ^= byte;
+		result *= 1099511628211ull;
+	}
+
+	return result;
+}
+
+void SoftwareTarget::copyToImage(sf::Image& image) const
+{
+	image.create(m_size.x, m_size.y, m_pixels.data());
+}
+
+sf::Time SoftwareTarget::getRasterTime() const
+{
+	return m_rasterTime;
+}
+
+void SoftwareTarget::drawTriangle(const sf::Vertex& v0, const sf::Vertex& v1, const sf::Vertex& v2, const sf::Image* image)
+{
+	const sf::Vector2f& p0 = v0.position;
+	sf::Vector2f p1 = v1.position;
+	sf::Vector2f p2 = v2.position;
+
+	const sf::Vertex* a = &v1;
+	const sf::Vertex* b = &v2;
+
+	float area = edge(p0, p1, p2);
+
+	if (area == 0.f)
+		return;
+
+	// counter-clockwise on screen (y down)
+	if (area < 0.f)
+	{
+		std::swap(p1, p2);
+		std::swap(a, b);
+		area = -area;
+	}
+
+	const int left = std::max(0, static_cast<int>(std::floor(std::min({ p0.x, p1.x, p2.x }))));
+	const int top = std::max(0, static_cast<int>(std::floor(std::min({ p0.y, p1.y, p2.y }))));
+	const int right = std::min(static_cast<int>(m_size.x), static_cast<int>(std::ceil(std::max({ p0.x, p1.x, p2.x }))));
+	const int bottom = std::min(static_cast<int>(m_size.y), static_cast<int>(std::ceil(std::max({ p0.y, p1.y, p2.y }))));
+
+	const bool topLeft0 = isTopLeft(p1, p2);
+	const bool topLeft1 = isTopLeft(p2, p0);
+	const bool topLeft2 = isTopLeft(p0, p1);
+
+	const sf::Vector2u imageSize = image ? image->getSize() : sf::Vector2u();
+
+	for (int y = top; y < bottom; ++y)
+		for (int x = left; x < right; ++x)
+		{
+			// pixel center
+			const sf::Vector2f p(x + 0.5f, y + 0.5f);
+
+			const float w0 = edge(p1, p2, p);
+			const float w1 = edge(p2, p0, p);
+			const float w2 = edge(p0, p1, p);
+
+			if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+				continue;
+
+			if ((w0 == 0.f && !topLeft0) || (w1 == 0.f && !topLeft1) || (w2 == 0.f && !topLeft2))
+				continue;
+
+			const float l0 = w0 / area;
+			const float l1 = w1 / area;
+			const float l2 = w2 / area;
+
+			const auto interpolate = [&] (sf::Uint8 c0, sf::Uint8 c1, sf::Uint8 c2)
+			{
+				return l0 * c0 + l1 * c1 + l2 * c2;
+			};
+
+			float r = interpolate(v0.color.r, a->color.r, b->color.r);
+			float g = interpolate(v0.color.g, a->color.g, b->color.g);
+			float bl = interpolate(v0.color.b, a->color.b, b->color.b);
+			float alpha = interpolate(v0.color.a, a->color.a, b->color.a);
+
+			if (image)
+			{
+				const float u = l0 * v0.texCoords.x + l1 * a->texCoords.x + l2 * b->texCoords.x;
+				const float v = l0 * v0.texCoords.y + l1 * a->texCoords.y + l2 * b->texCoords.y;
+
+				const unsigned int tx = std::min(imageSize.x - 1, static_cast<unsigned int>(std::max(0.f, u)));
+				const unsigned int ty = std::min(imageSize.y - 1, static_cast<unsigned int>(std::max(0.f, v)));
+
+				const sf::Color texel = image->getPixel(tx, ty);
+
+				r = r * texel.r / 255.f;
+				g = g * texel.g / 255.f;
+				bl = bl * texel.b / 255.f;
+				alpha = alpha * texel.a / 255.f;
+			}
+
+			// sf::BlendAlpha
+			sf::Uint8* pixel = &m_pixels[(x + y * m_size.x) * 4];
+			const float s = alpha / 255.f;
+
+			pixel[0] = static_cast<sf::Uint8>(r * s + pixel[0] * (1.f - s) + 0.5f);
+			pixel[1] = static_cast<sf::Uint8>(g * s + pixel[1] * (1.f - s) + 0.5f);
+			pixel[2] = static_cast<sf::Uint8>(bl * s + pixel[2] * (1.f - s) + 0.5f);
+			pixel[3] = static_cast<sf::Uint8>(alpha + pixel[3] * (1.f - s) + 0.5f);
+		}
+}
+
+}
@@ -4,6 +4,16 @@
 namespace rl
 {
 
+bool State::isOpaque() const
+{
+	return false;
+}
+
+bool State::isCachingBelow() const
+{
+	return false;
+}
+
 void State::setStateStack(StateStack& stack)
 {
 	m_stack = &stack;
@@ -19,6 +29,11 @@ void State::clearStates()
 	m_stack->clearStates();
 }
 
+void State::invalidateCache()
+{
+	m_stack->invalidateCache();
+}
+
 void State::pushState(State::Ptr state)
 {
 	m_stack->pushState(std::move(state));
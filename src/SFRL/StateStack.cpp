@@ -1,6 +1,7 @@
 #include "StateStack.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Sprite.hpp>
 
 namespace rl
 {
@@ -26,30 +27,56 @@ void StateStack::clearStates()
 	m_pendingList.emplace_back(Action::Clear, nullptr);
 }
 
+void StateStack::invalidateCache()
+{
+	m_cachedLast = 0;
+}
+
 void StateStack::handleEvent(const sf::Event& event)
 {
+	// the lowest state reached
+	std::size_t handled = m_stack.size();
+
 	for (auto it = m_stack.rbegin(); it != m_stack.rend(); ++it)
 	{
+		--handled;
+
 		if (!(*it)->handleEvent(event))
 			break;
 	}
 
+	// NOTE: a cached state that handled the event may have changed
+	if (handled < m_cachedLast)
+		m_cachedLast = 0;
+
 	applyPendingChanges();
 }
 
 void StateStack::update(sf::Time dt)
 {
+	// the lowest state reached
+	std::size_t updated = m_stack.size();
+
 	for (auto it = m_stack.rbegin(); it != m_stack.rend(); ++it)
 	{
+		--updated;
+
 		if (!(*it)->update(dt))
 			break;
 	}
 
+	// NOTE: a cached state that was updated may have changed (e.g. an animation)
+	if (updated < m_cachedLast)
+		m_cachedLast = 0;
+
 	applyPendingChanges();
 }
 
 void StateStack::applyPendingChanges()
 {
+	if (!m_pendingList.empty())
+		m_cachedLast = 0;
+
 	for (auto& [action, state] : m_pendingList)
 	{
 		switch (action)
@@ -71,10 +98,68 @@ void StateStack::applyPendingChanges()
 	m_pendingList.clear();
 }
 
+bool StateStack::drawCache(sf::RenderTarget& target, const sf::RenderStates& states, std::size_t first, std::size_t last) const
+{
+	const sf::Vector2u size = target.getSize();
+
+	// NOTE: a render texture needs an OpenGL context, created here so that a headless stack never opens one
+	if (!m_cache)
+		m_cache = std::make_unique<sf::RenderTexture>();
+
+	if (m_cache->getSize() != size)
+	{
+		m_cachedLast = 0;
+
+		if (!m_cache->create(size.x, size.y))
+			return false;
+	}
+
+	if (m_cachedFirst != first || m_cachedLast != last)
+	{
+		m_cache->setView(target.getView());
+		m_cache->clear();
+
+		for (std::size_t i = first; i < last; ++i)
+			m_cache->draw(*m_stack[i], states);
+
+		m_cache->display();
+
+		m_cachedFirst = first;
+		m_cachedLast = last;
+	}
+
+	// NOTE: the states may change the view
+	const sf::View view = target.getView();
+
+	target.setView(target.getDefaultView());
+	target.draw(sf::Sprite(m_cache->getTexture()));
+	target.setView(view);
+
+	return true;
+}
+
 void StateStack::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-	for (const auto& state : m_stack)
-		target.draw(*state, states);
+	// the states below the top opaque state are covered
+	std::size_t first = m_stack.size();
+
+	while (first > 0 && !m_stack[first - 1]->isOpaque())
+		--first;
+
+	if (first > 0)
+		--first;
+
+	// the states below the top caching state come from the cache
+	std::size_t last = m_stack.size();
+
+	while (last > first + 1 && !m_stack[last - 1]->isCachingBelow())
+		--last;
+
+	if (last > first + 1 && drawCache(target, states, first, last - 1))
+		first = last - 1;
+
+	for (std::size_t i = first; i < m_stack.size(); ++i)
+		target.draw(*m_stack[i], states);
 }
 
 }
@@ -0,0 +1,263 @@
+#include "Terminal.hpp"
+#include "Console.hpp"
+
+namespace
+{
+	// src over dst
+	sf::Color blend(const sf::Color& src, const sf::Color& dst)
+	{
+		const auto mix = [&src] (sf::Uint8 s, sf::Uint8 d)
+		{
+			return static_cast<sf::Uint8>((s * src.a + d * (255 - src.a)) / 255);
+		};
+
+		return { mix(src.r, dst.r), mix(src.g, dst.g), mix(src.b, dst.b) };
+	}
+
+	// hangul, cjk and fullwidth forms take two columns
+	bool isWide(wchar_t ch)
+	{
+		return (ch >= 0x1100 && ch <= 0x115f) || (ch >= 0x2e80 && ch <= 0xa4cf) || (ch >= 0xac00 && ch <= 0xd7a3) ||
+			(ch >= 0xf900 && ch <= 0xfaff) || (ch >= 0xff00 && ch <= 0xff60);
+	}
+
+	// the right half of a wide character on the terminal
+	constexpr wchar_t WideRight = static_cast<wchar_t>(0xffff);
+}
+
+namespace rl
+{
+
+bool Terminal::Cell::operator==(const Cell& cell) const
+{
+	return ch == cell.ch && text == cell.text && background == cell.background;
+}
+
+bool Terminal::Cell::operator!=(const Cell& cell) const
+{
+	return !(*this == cell);
+}
+
+Terminal::Terminal(std::ostream& stream)
+	: m_stream(stream)
+{
+}
+
+Terminal::~Terminal()
+{
+	// reset colors, show the cursor and move it below the console
+	m_buffer = "\x1b[0m\x1b[?25h";
+	moveTo(0, m_size.y);
+	m_buffer += '\n';
+
+	m_stream.write(m_buffer.data(), m_buffer.size());
+	m_stream.flush();
+}
+
+void Terminal::present(const Console& console)
+{
+	m_buffer.clear();
+
+	if (console.getSize() != m_size)
+	{
+		m_size = console.getSize();
+		m_needsClear = true;
+	}
+
+	if (m_needsClear)
+	{
+		// reset colors, hide the cursor and clear the screen
+		m_buffer += "\x1b[0m\x1b[?25l\x1b[2J";
+		m_cells.assign(m_size.x * m_size.y, Cell());
+		m_cursor = { -1, -1 };
+		m_colorsKnown = false;
+		m_needsClear = false;
+	}
+
+	for (int y = 0; y < m_size.y; ++y)
+	{
+		Cell previous;
+
+		for (int x = 0; x < m_size.x; ++x)
+		{
+			Cell cell = getCell(console, x, y);
+
+			// NOTE: the cell under the right half of a wide character is not written (it would split the character),
+			//       it is redrawn once the wide character changes
+			if (isWide(previous.ch))
+			{
+				cell = previous;
+				cell.ch = WideRight;
+			}
+
+			// the terminal would wrap it to the next line
+			else if (isWide(cell.ch) && x + 1 == m_size.x)
+			{
+				cell.ch = L' ';
+				cell.text = cell.background;
+			}
+
+			previous = cell;
+
+			Cell& current = m_cells[x + y * m_size.x];
+
+			if (cell == current)
+				continue;
+
+			if (cell.ch == WideRight)
+			{
+				current = cell;
+				continue;
+			}
+
+			moveTo(x, y);
+
+			// the text color of a space does not matter
+			if (cell.ch == L' ' && m_colorsKnown)
+				setColors(m_text, cell.background);
+			else
+				setColors(cell.text, cell.background);
+
+			appendChar(cell.ch);
+
+			current = cell;
+
+			// NOTE: a wide character covers the next cell, whatever was written there
+			if (isWide(cell.ch))
+			{
+				m_cells[x + 1 + y * m_size.x] = cell;
+				m_cells[x + 1 + y * m_size.x].ch = WideRight;
+			}
+
+			// NOTE: the cursor waits at the last column (auto wrap)
+			const int width = isWide(cell.ch) ? 2 : 1;
+
+			if (x + width < m_size.x)
+				m_cursor.x += width;
+			else
+				m_cursor = { -1, -1 };
+		}
+	}
+
+	m_frameSize = m_buffer.size();
+
+	if (!m_buffer.empty())
+	{
+		m_stream.write(m_buffer.data(), m_buffer.size());
+		m_stream.flush();
+	}
+}
+
+void Terminal::invalidate()
+{
+	m_needsClear = true;
+}
+
+std::size_t Terminal::getFrameSize() const
+{
+	return m_frameSize;
+}
+
+Terminal::Cell Terminal::getCell(const Console& console, int x, int y) const
+{
+	const sf::Color background = blend(console.getColor(x, y, Console::Background), sf::Color::Black);
+	const sf::Color& foreground = console.getColor(x, y, Console::Foreground);
+
+	Cell cell;
+	cell.ch = console.getChar(x, y);
+	cell.text = blend(console.getColor(x, y, Console::TextLayer), background);
+	cell.background = background;
+
+	if (cell.ch == 0 || console.getColor(x, y, Console::TextLayer).a == 0)
+		cell.ch = L' ';
+	else if (cell.ch == WideRight)
+		cell.ch = L'?';
+
+	// the foreground covers the text and the background
+	if (foreground.a > 0)
+	{
+		cell.text = blend(foreground, cell.text);
+		cell.background = blend(foreground, cell.background);
+	}
+
+	if (cell.ch == L' ')
+		cell.text = cell.background;
+
+	return cell;
+}
+
+void Terminal::moveTo(int x, int y)
+{
+	if (m_cursor.x == x && m_cursor.y == y)
+		return;
+
+	m_buffer += "\x1b[";
+	m_buffer += std::to_string(y + 1);
+	m_buffer += ';';
+	m_buffer += std::to_string(x + 1);
+	m_buffer += 'H';
+
+	m_cursor = { x, y };
+}
+
+void Terminal::setColors(const sf::Color& text, const sf::Color& background)
+{
+	if (!m_colorsKnown || text != m_text)
+		appendColor("\x1b[38;2;", text);
+
+	if (!m_colorsKnown || background != m_background)
+		appendColor("\x1b[48;2;", background);
+
+	m_text = text;
+	m_background = background;
+	m_colorsKnown = true;
+}
+
+void Terminal::appendChar(wchar_t ch)
+{
+	auto code = static_cast<unsigned int>(ch);
+
+	// NOTE: control codes (c0, del, c1) would let the console text send escape sequences to the terminal,
+	//       surrogates and codes past unicode are not valid utf-8
+	if (code < 0x20 || (code >= 0x7f && code < 0xa0) || (code >= 0xd800 && code < 0xe000) || code > 0x10ffff)
+		code = '?';
+
+	// utf-8
+
+	if (code < 0x80)
+		m_buffer += static_cast<char>(code);
+
+	else if (code < 0x800)
+	{
+		m_buffer += static_cast<char>(0xc0 | (code >> 6));
+		m_buffer += static_cast<char>(0x80 | (code & 0x3f));
+	}
+
+	else if (code < 0x10000)
+	{
+		m_buffer += static_cast<char>(0xe0 | (code >> 12));
+		m_buffer += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+		m_buffer += static_cast<char>(0x80 | (code & 0x3f));
+	}
+
+	else
+	{
+		m_buffer += static_cast<char>(0xf0 | (code >> 18));
+		m_buffer += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+		m_buffer += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+		m_buffer += static_cast<char>(0x80 | (code & 0x3f));
+	}
+}
+
+void Terminal::appendColor(const char* prefix, const sf::Color& color)
+{
+	m_buffer += prefix;
+	m_buffer += std::to_string(color.r);
+	m_buffer += ';';
+	m_buffer += std::to_string(color.g);
+	m_buffer += ';';
+	m_buffer += std::to_string(color.b);
+	m_buffer += 'm';
+}
+
+}
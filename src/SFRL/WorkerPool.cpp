@@ -0,0 +1,81 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+namespace rl
+{
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+{
+	for (unsigned int i = 1; i < std::max(1u, threadCount); ++i)
+		m_threads.emplace_back(&WorkerPool::loop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_started.notify_all();
+
+	for (auto& thread : m_threads)
+		thread.join();
+}
+
+unsigned int WorkerPool::getThreadCount() const
+{
+	return static_cast<unsigned int>(m_threads.size()) + 1;
+}
+
+void WorkerPool::run(const std::function<void()>& work)
+{
+	if (m_threads.empty())
+	{
+		work();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_work = &work;
+		m_running = m_threads.size();
+		++m_job;
+	}
+
+	m_started.notify_all();
+
+	work();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_finished.wait(lock, [this] () { return m_running == 0; });
+	m_work = nullptr;
+}
+
+void WorkerPool::loop()
+{
+	std::size_t job = 0;
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_started.wait(lock, [this, job] () { return m_stopping || m_job != job; });
+
+		if (m_stopping)
+			return;
+
+		job = m_job;
+		const std::function<void()>& work = *m_work;
+		lock.unlock();
+
+		work();
+
+		lock.lock();
+
+		if (--m_running == 0)
+			m_finished.notify_one();
+	}
+}
+
+}